@@ -0,0 +1,525 @@
+/**
+ *  @file app_adv_filter.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Pre-filter for scanned advertisements, run in scan ISR before data is
+ *  copied into scheduler queue.
+ */
+
+#include "app_adv_filter.h"
+#include "app_adv_match.h"
+#include "app_adv_pool.h"
+#include "app_clock.h"
+#include "app_config.h"
+#include "app_mac_list.h"
+#include "app_tag_table.h"
+#include "ruuvi_boards.h"
+#include "ruuvi_endpoint_ca_uart.h"
+
+#define APP_ADV_FILTER_ENABLED_BIT (1UL << 0U) //!< Filter enabled bit of cache.
+#define APP_ADV_FILTER_NO_ID_BIT   (1UL << 1U) //!< Accept advs without manufacturer data.
+#define APP_ADV_FILTER_SET_BIT     (1UL << 2U) //!< Active manufacturer ID table.
+#define APP_ADV_FILTER_ID_SLOTS    (16U)       //!< Power of two, at most half full.
+#define APP_ADV_FILTER_ID_HASH     (0x9E37U)   //!< Fibonacci hashing multiplier.
+#define APP_ADV_FILTER_ID_HASH_POS (12U)       //!< Keep top 4 bits of hash.
+#define APP_ADV_FILTER_ID_SLOT(id) \
+    ((uint8_t) ((uint16_t) ((id) * APP_ADV_FILTER_ID_HASH) >> APP_ADV_FILTER_ID_HASH_POS))
+#define APP_ADV_FILTER_AD_TYPE_MANUFACTURER (0xFFU) //!< Manufacturer specific data.
+#define APP_ADV_FILTER_RSSI_FLOOR_MASK (0x00FFU) //!< RSSI floor bits of cache.
+#define APP_ADV_FILTER_RSSI_HYST_POS   (8U)      //!< RSSI hysteresis position in cache.
+#define APP_ADV_FILTER_RSSI_OFF        ((uint16_t) (uint8_t) INT8_MIN) //!< No RSSI floor.
+#define APP_ADV_FILTER_FNV_OFFSET  (2166136261UL) //!< FNV-1a 32-bit offset basis.
+#define APP_ADV_FILTER_FNV_PRIME   (16777619UL)   //!< FNV-1a 32-bit prime.
+
+_Static_assert (APP_ADV_FILTER_ID_SLOTS >= (2U * (APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX + 1U)),
+                "Manufacturer ID table must stay at most half full");
+_Static_assert (APP_ADV_FILTER_ID_SLOTS == (1U << (16U - APP_ADV_FILTER_ID_HASH_POS)),
+                "Manufacturer ID hash must cover the table");
+_Static_assert (APP_ADV_FILTER_ID_SLOTS <= 16U, "Slot occupancy must fit uint16_t");
+_Static_assert ((APP_ADV_SHED_REPEAT_PERCENT <= APP_ADV_SHED_WEAK_PERCENT)
+                && (APP_ADV_SHED_WEAK_PERCENT <= APP_ADV_SHED_NARROW_PERCENT)
+                && (APP_ADV_SHED_NARROW_PERCENT <= 100U),
+                "Load shedding levels must be in order");
+
+/**
+ * @brief Manufacturer filter flags and active ID table packed into one word.
+ *
+ * Default matches app_ble default scan parameters.
+ */
+static volatile uint32_t m_manufacturer_filter = APP_ADV_FILTER_ENABLED_BIT;
+/**
+ * @brief Open addressed sets of accepted manufacturer IDs.
+ *
+ * Every 16-bit value is a valid ID, so occupied slots are marked in a bitmap
+ * next to each set. Sets are rebuilt into the inactive table, so ISR never
+ * sees a half-built set.
+ */
+static uint16_t m_manufacturer_ids[2][APP_ADV_FILTER_ID_SLOTS] =
+{
+    [0] = {
+        [APP_ADV_FILTER_ID_SLOT (RB_BLE_MANUFACTURER_ID)] = RB_BLE_MANUFACTURER_ID
+    }
+};
+/** @brief Occupied slots of m_manufacturer_ids, bit per slot. */
+static uint16_t m_manufacturer_used[2] =
+{
+    [0] = (uint16_t) (1U << APP_ADV_FILTER_ID_SLOT (RB_BLE_MANUFACTURER_ID))
+};
+static uint16_t m_manufacturer_id = RB_BLE_MANUFACTURER_ID;
+static uint16_t m_manufacturer_extra[APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX];
+static uint8_t m_manufacturer_extra_count;
+static volatile uint32_t m_rejects[APP_ADV_FILTER_REASON_NUM];
+static volatile uint16_t m_dedup_window_ms;
+static volatile uint16_t m_rate_limit_ms;
+/** @brief RSSI floor and hysteresis packed into one halfword, floor INT8_MIN is off. */
+static volatile uint16_t m_rssi_filter = APP_ADV_FILTER_RSSI_OFF;
+/** @brief Highest app_adv_filter_shed_t applied since last taken. */
+static uint8_t m_shed_peak;
+/** @brief Tag state of last accepted advertisement, applied once it is pooled. */
+static struct
+{
+    app_tag_t * p_tag;     //!< Tag to update, NULL if nothing is pending.
+    uint32_t fingerprint;  //!< Fingerprint of accepted payload.
+    uint32_t forwarded_ms; //!< Time of acceptance.
+} m_accepted;
+
+static uint32_t app_adv_filter_fingerprint (const uint8_t * const p_data,
+        const size_t len)
+{
+    uint32_t hash = APP_ADV_FILTER_FNV_OFFSET;
+
+    for (size_t ii = 0; ii < len; ii++)
+    {
+        hash ^= p_data[ii];
+        hash *= APP_ADV_FILTER_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static bool app_adv_filter_id_is_used (const uint16_t used, const uint8_t slot)
+{
+    return 0U != (used & (1U << slot));
+}
+
+static bool app_adv_filter_id_is_accepted (const uint16_t * const p_ids,
+        const uint16_t used, const uint16_t manufacturer_id)
+{
+    uint8_t slot = APP_ADV_FILTER_ID_SLOT (manufacturer_id);
+
+    // Table is at most half full, probe ends on a free slot in a few steps.
+    while (app_adv_filter_id_is_used (used, slot) && (manufacturer_id != p_ids[slot]))
+    {
+        slot = (uint8_t) ((slot + 1U) & (APP_ADV_FILTER_ID_SLOTS - 1U));
+    }
+
+    return app_adv_filter_id_is_used (used, slot);
+}
+
+static void app_adv_filter_id_insert (uint16_t * const p_ids, uint16_t * const p_used,
+                                      const uint16_t manufacturer_id)
+{
+    uint8_t slot = APP_ADV_FILTER_ID_SLOT (manufacturer_id);
+
+    while (app_adv_filter_id_is_used (*p_used, slot) && (manufacturer_id != p_ids[slot]))
+    {
+        slot = (uint8_t) ((slot + 1U) & (APP_ADV_FILTER_ID_SLOTS - 1U));
+    }
+
+    p_ids[slot] = manufacturer_id;
+    *p_used = (uint16_t) (*p_used | (1U << slot));
+}
+
+/**
+ * @brief Check if advertisement has a manufacturer specific data field.
+ */
+static bool app_adv_filter_has_manufacturer_data (const uint8_t * const p_data,
+        const size_t data_len)
+{
+    bool has_data = false;
+    size_t offset = 0;
+
+    // AD structure is length, type, data. Length counts type and data.
+    while (!has_data && ((offset + 1U) < data_len) && (0U != p_data[offset]))
+    {
+        has_data = (APP_ADV_FILTER_AD_TYPE_MANUFACTURER == p_data[offset + 1U]);
+        offset += (size_t) p_data[offset] + 1U;
+    }
+
+    return has_data;
+}
+
+/**
+ * @brief Rebuild inactive manufacturer ID table and activate it.
+ *
+ * Must be called from one context only, ISR reads the active table.
+ */
+static void app_adv_filter_manufacturer_publish (const bool enabled, const bool accept_none)
+{
+    const uint32_t active = m_manufacturer_filter & APP_ADV_FILTER_SET_BIT;
+    const uint8_t next = (0U == active) ? 1U : 0U;
+    uint16_t * const p_ids = m_manufacturer_ids[next];
+    uint16_t * const p_used = &m_manufacturer_used[next];
+    uint32_t filter = (0U == next) ? 0UL : APP_ADV_FILTER_SET_BIT;
+
+    *p_used = 0U;
+    app_adv_filter_id_insert (p_ids, p_used, m_manufacturer_id);
+
+    for (size_t ii = 0; ii < m_manufacturer_extra_count; ii++)
+    {
+        app_adv_filter_id_insert (p_ids, p_used, m_manufacturer_extra[ii]);
+    }
+
+    filter |= enabled ? APP_ADV_FILTER_ENABLED_BIT : 0UL;
+    filter |= accept_none ? APP_ADV_FILTER_NO_ID_BIT : 0UL;
+    m_manufacturer_filter = filter;
+}
+
+/**
+ * @brief Check manufacturer ID of advertisement against accepted set.
+ *
+ * @return True if advertisement should be rejected.
+ */
+static bool app_adv_filter_manufacturer_is_rejected (const ri_adv_scan_t * const p_scan,
+        const uint32_t filter)
+{
+    bool is_rejected = false;
+
+    if (0U != (filter & APP_ADV_FILTER_ENABLED_BIT))
+    {
+        const uint8_t set = (0U == (filter & APP_ADV_FILTER_SET_BIT)) ? 0U : 1U;
+        // Parser does not modify data, cast is safe.
+        const uint16_t manufacturer_id = ri_adv_parse_manuid ((uint8_t *) p_scan->data,
+                                         p_scan->data_len);
+        is_rejected = !app_adv_filter_id_is_accepted (m_manufacturer_ids[set],
+                      m_manufacturer_used[set], manufacturer_id);
+
+        if (is_rejected && (0U != (filter & APP_ADV_FILTER_NO_ID_BIT)))
+        {
+            is_rejected = app_adv_filter_has_manufacturer_data (p_scan->data,
+                          p_scan->data_len);
+        }
+    }
+
+    return is_rejected;
+}
+
+static int8_t app_adv_filter_rssi_floor (const uint16_t rssi_filter)
+{
+    return (int8_t) (rssi_filter & APP_ADV_FILTER_RSSI_FLOOR_MASK);
+}
+
+static uint8_t app_adv_filter_rssi_hysteresis (const uint16_t rssi_filter)
+{
+    return (uint8_t) (rssi_filter >> APP_ADV_FILTER_RSSI_HYST_POS);
+}
+
+/**
+ * @brief Check RSSI against the lowest level any tag can pass at.
+ *
+ * Advertisements in the hysteresis band are decided per tag later. A tracked
+ * tag below the band leaves range, lookup does not add new tags to table.
+ */
+static bool app_adv_filter_rssi_is_low (const ri_adv_scan_t * const p_scan,
+                                        const uint16_t rssi_filter)
+{
+    const int8_t floor_dbm = app_adv_filter_rssi_floor (rssi_filter);
+    const uint8_t hysteresis_db = app_adv_filter_rssi_hysteresis (rssi_filter);
+    const int16_t lowest_dbm = (int16_t) floor_dbm - (int16_t) hysteresis_db;
+    const bool is_low = (INT8_MIN != floor_dbm) && ((int16_t) p_scan->rssi < lowest_dbm);
+
+    if (is_low && (0U < hysteresis_db))
+    {
+        app_tag_t * const p_tag = app_tag_table_find (p_scan->addr);
+
+        if (NULL != p_tag)
+        {
+            p_tag->in_range = false;
+        }
+    }
+
+    return is_low;
+}
+
+/**
+ * @brief Apply per-tag RSSI hysteresis.
+ *
+ * A tag enters range at floor and leaves it below floor minus hysteresis.
+ *
+ * @return True if tag is in range.
+ */
+static bool app_adv_filter_rssi_in_range (app_tag_t * const p_tag, const int8_t rssi,
+        const uint16_t rssi_filter)
+{
+    const int8_t floor_dbm = app_adv_filter_rssi_floor (rssi_filter);
+    int16_t threshold = floor_dbm;
+
+    if (p_tag->in_range)
+    {
+        threshold -= app_adv_filter_rssi_hysteresis (rssi_filter);
+    }
+
+    p_tag->in_range = ((INT8_MIN == floor_dbm) || ((int16_t) rssi >= threshold));
+    return p_tag->in_range;
+}
+
+/**
+ * @brief Apply per-tag RSSI hysteresis, duplicate suppression, repeat shedding
+ *        and rate limit.
+ *
+ * Accepted advertisements are recorded as forwarded by @ref app_adv_filter_commit.
+ */
+static app_adv_filter_reason_t app_adv_filter_tag_check (const ri_adv_scan_t * const
+        p_scan, const uint16_t rssi_filter, const app_adv_filter_shed_t shed)
+{
+    app_adv_filter_reason_t reason = APP_ADV_FILTER_ACCEPT;
+    const uint32_t window_ms = m_dedup_window_ms;
+    const uint32_t interval_ms = m_rate_limit_ms;
+    const bool is_hysteresis = (INT8_MIN != app_adv_filter_rssi_floor (rssi_filter))
+                               && (0U < app_adv_filter_rssi_hysteresis (rssi_filter));
+    const bool is_shed_repeat = (APP_ADV_FILTER_SHED_REPEAT <= shed);
+
+    if (is_hysteresis || (0U < window_ms) || (0U < interval_ms) || is_shed_repeat)
+    {
+        const uint32_t now_ms = app_clock_ms_get();
+        const uint32_t fingerprint = ((0U < window_ms) || is_shed_repeat)
+                                     ? app_adv_filter_fingerprint (p_scan->data,
+                                             p_scan->data_len)
+                                     : 0U;
+        bool is_new = false;
+        app_tag_t * const p_tag = app_tag_table_get (p_scan->addr, now_ms, &is_new);
+        const uint32_t elapsed_ms = now_ms - p_tag->forwarded_ms;
+
+        if (!app_adv_filter_rssi_in_range (p_tag, p_scan->rssi, rssi_filter))
+        {
+            reason = APP_ADV_FILTER_REJECT_RSSI;
+        }
+        else if (!p_tag->is_forwarded)
+        {
+            // No action needed.
+        }
+        else if ((fingerprint == p_tag->fingerprint) && (elapsed_ms < window_ms))
+        {
+            reason = APP_ADV_FILTER_REJECT_DUPLICATE;
+        }
+        // Shedding drops a repeat however long ago it was forwarded.
+        else if (is_shed_repeat && (fingerprint == p_tag->fingerprint))
+        {
+            reason = APP_ADV_FILTER_REJECT_SHED_REPEAT;
+        }
+        else if (elapsed_ms < interval_ms)
+        {
+            reason = APP_ADV_FILTER_REJECT_RATE_LIMIT;
+        }
+        else
+        {
+            // No action needed.
+        }
+
+        if (APP_ADV_FILTER_ACCEPT == reason)
+        {
+            m_accepted.p_tag = p_tag;
+            m_accepted.fingerprint = fingerprint;
+            m_accepted.forwarded_ms = now_ms;
+        }
+    }
+
+    return reason;
+}
+
+/**
+ * @brief Get shed level of current pool fill and record it in peak.
+ *
+ * Called from scan ISR only, @ref app_adv_filter_shed_peak_take may interrupt.
+ */
+static app_adv_filter_shed_t app_adv_filter_shed_update (void)
+{
+    const app_adv_filter_shed_t shed = app_adv_filter_shed_level_get();
+
+    if ((uint8_t) shed > __atomic_load_n (&m_shed_peak, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n (&m_shed_peak, (uint8_t) shed, __ATOMIC_RELAXED);
+    }
+
+    return shed;
+}
+
+void app_adv_filter_manufacturer_set (const bool enabled, const uint16_t manufacturer_id)
+{
+    m_manufacturer_id = manufacturer_id;
+    app_adv_filter_manufacturer_publish (enabled,
+                                         0U != (m_manufacturer_filter & APP_ADV_FILTER_NO_ID_BIT));
+}
+
+rd_status_t app_adv_filter_manufacturer_extra_set (const uint16_t * const p_ids,
+        const size_t count, const bool accept_none)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((NULL == p_ids) && (0U < count))
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if (APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX < count)
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            m_manufacturer_extra[ii] = p_ids[ii];
+        }
+
+        m_manufacturer_extra_count = (uint8_t) count;
+        app_adv_filter_manufacturer_publish (
+            0U != (m_manufacturer_filter & APP_ADV_FILTER_ENABLED_BIT), accept_none);
+    }
+
+    return err_code;
+}
+
+void app_adv_filter_dedup_window_set (const uint16_t window_ms)
+{
+    m_dedup_window_ms = window_ms;
+}
+
+rd_status_t app_adv_filter_rate_limit_set (const uint16_t interval_ms)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (APP_ADV_FILTER_RATE_LIMIT_MAX_MS < interval_ms)
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        m_rate_limit_ms = interval_ms;
+    }
+
+    return err_code;
+}
+
+void app_adv_filter_rssi_floor_set (const int8_t floor_dbm, const uint8_t hysteresis_db)
+{
+    const uint16_t hysteresis = (uint16_t) hysteresis_db << APP_ADV_FILTER_RSSI_HYST_POS;
+    m_rssi_filter = (uint16_t) ((uint16_t) (uint8_t) floor_dbm | hysteresis);
+}
+
+app_adv_filter_shed_t app_adv_filter_shed_level_get (void)
+{
+    const uint8_t fill = app_adv_pool_fill_get();
+    app_adv_filter_shed_t shed = APP_ADV_FILTER_SHED_NONE;
+
+    if (APP_ADV_SHED_NARROW_PERCENT <= fill)
+    {
+        shed = APP_ADV_FILTER_SHED_NARROW;
+    }
+    else if (APP_ADV_SHED_WEAK_PERCENT <= fill)
+    {
+        shed = APP_ADV_FILTER_SHED_WEAK;
+    }
+    else if (APP_ADV_SHED_REPEAT_PERCENT <= fill)
+    {
+        shed = APP_ADV_FILTER_SHED_REPEAT;
+    }
+    else
+    {
+        // No action needed.
+    }
+
+    return shed;
+}
+
+app_adv_filter_shed_t app_adv_filter_shed_peak_take (void)
+{
+    const uint8_t shed = (uint8_t) app_adv_filter_shed_level_get();
+    return (app_adv_filter_shed_t) __atomic_exchange_n (&m_shed_peak, shed,
+            __ATOMIC_RELAXED);
+}
+
+void app_adv_filter_reject (const app_adv_filter_reason_t reason)
+{
+    if ((APP_ADV_FILTER_ACCEPT < reason) && (APP_ADV_FILTER_REASON_NUM > reason))
+    {
+        m_rejects[reason]++;
+    }
+}
+
+app_adv_filter_reason_t app_adv_filter_check (const ri_adv_scan_t * const p_scan,
+        const size_t data_len)
+{
+    app_adv_filter_reason_t reason = APP_ADV_FILTER_ACCEPT;
+    const uint32_t filter = m_manufacturer_filter;
+    const uint16_t rssi_filter = m_rssi_filter;
+    const app_adv_filter_shed_t shed = app_adv_filter_shed_update();
+    m_accepted.p_tag = NULL;
+
+    if ((NULL == p_scan) || (sizeof (ri_adv_scan_t) != data_len)
+            || (RE_CA_UART_ADV_BYTES < p_scan->data_len))
+    {
+        reason = APP_ADV_FILTER_REJECT_INVALID;
+    }
+    // Cheapest check first, weak tags are the bulk of far-away traffic.
+    else if (app_adv_filter_rssi_is_low (p_scan, rssi_filter))
+    {
+        reason = APP_ADV_FILTER_REJECT_RSSI;
+    }
+    else if ((APP_ADV_FILTER_SHED_WEAK <= shed) && (APP_ADV_SHED_RSSI_DBM > p_scan->rssi))
+    {
+        reason = APP_ADV_FILTER_REJECT_SHED_RSSI;
+    }
+    else if (!app_mac_list_is_passed (p_scan->addr))
+    {
+        reason = APP_ADV_FILTER_REJECT_MAC_LIST;
+    }
+    else if (app_adv_filter_manufacturer_is_rejected (p_scan, filter))
+    {
+        reason = APP_ADV_FILTER_REJECT_MANUFACTURER;
+    }
+    else if (!app_adv_match_check (p_scan->data, p_scan->data_len))
+    {
+        reason = APP_ADV_FILTER_REJECT_MATCH;
+    }
+    else
+    {
+        reason = app_adv_filter_tag_check (p_scan, rssi_filter, shed);
+    }
+
+    app_adv_filter_reject (reason);
+    return reason;
+}
+
+void app_adv_filter_commit (void)
+{
+    app_tag_t * const p_tag = m_accepted.p_tag;
+
+    if (NULL != p_tag)
+    {
+        p_tag->fingerprint = m_accepted.fingerprint;
+        p_tag->forwarded_ms = m_accepted.forwarded_ms;
+        p_tag->is_forwarded = true;
+        m_accepted.p_tag = NULL;
+    }
+}
+
+uint32_t app_adv_filter_rejects_get (const app_adv_filter_reason_t reason)
+{
+    uint32_t rejects = 0;
+
+    if ((APP_ADV_FILTER_ACCEPT < reason) && (APP_ADV_FILTER_REASON_NUM > reason))
+    {
+        rejects = m_rejects[reason];
+    }
+
+    return rejects;
+}
+
+void app_adv_filter_rejects_reset (void)
+{
+    for (size_t ii = 0; ii < APP_ADV_FILTER_REASON_NUM; ii++)
+    {
+        m_rejects[ii] = 0;
+    }
+}
@@ -0,0 +1,192 @@
+#ifndef APP_ADV_FILTER_H
+#define APP_ADV_FILTER_H
+
+/**
+ *  @file app_adv_filter.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Pre-filter for scanned advertisements, run in scan ISR before data is
+ *  copied into scheduler queue.
+ *
+ *  Filter state is a cached copy of application scan parameters, app_ble
+ *  updates the cache whenever the parameters change. Cache is kept in a single
+ *  word so that ISR never sees a half-updated filter.
+ *
+ *  Manufacturer filter accepts the scan parameter ID and up to
+ *  APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX extra IDs set by host. IDs are kept in
+ *  a small hash table, so lookup cost does not grow with the number of IDs.
+ *
+ *  Duplicate suppression keeps a fingerprint of the last forwarded payload of
+ *  each tag in app_tag_table. Tags repeat one payload on every channel and PHY,
+ *  only the first copy within the suppression window is forwarded.
+ *
+ *  Rate limit caps forwarded reports of each tag to one per interval. Tags
+ *  beyond APP_TAG_TABLE_LEN evict each other and are limited on best effort.
+ *  Interval restarts only from a report stored for forwarding, a report dropped
+ *  on a full pool does not hold back the next one.
+ *
+ *  RSSI floor drops weak advertisements. With hysteresis a tag enters range at
+ *  floor and leaves it only below floor minus hysteresis, so a tag at the edge
+ *  of range does not flap in and out.
+ *
+ *  MAC list forwards only listed tags or drops listed tags, see app_mac_list.
+ *  Payload match program selects e.g. data formats, see app_adv_match.
+ *
+ *  Load shedding degrades forwarding in steps as advertisement pool fills up,
+ *  so that an RF storm drops the least useful data instead of whatever arrives
+ *  at a full pool: first repeated payloads, then weak advertisements, finally
+ *  app_ble stops alternating to a second PHY. Shed advertisements are counted
+ *  by reason like filter rejections.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ruuvi_driver_error.h"
+#include "ruuvi_interface_communication_ble_advertising.h"
+
+#define APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX (7U) //!< Extra manufacturer IDs accepted.
+
+/**
+ * @brief Result of filtering an advertisement.
+ */
+typedef enum
+{
+    APP_ADV_FILTER_ACCEPT = 0,          //!< Advertisement passed the filter.
+    APP_ADV_FILTER_REJECT_INVALID,      //!< Event data was not a valid scan result.
+    APP_ADV_FILTER_REJECT_RSSI,         //!< RSSI was below floor.
+    APP_ADV_FILTER_REJECT_MAC_LIST,     //!< Tag was not allowed by MAC list.
+    APP_ADV_FILTER_REJECT_MANUFACTURER, //!< Manufacturer ID did not match.
+    APP_ADV_FILTER_REJECT_MATCH,        //!< Payload did not match program.
+    APP_ADV_FILTER_REJECT_DUPLICATE,    //!< Same payload was forwarded within window.
+    APP_ADV_FILTER_REJECT_RATE_LIMIT,   //!< Tag was forwarded within rate limit interval.
+    APP_ADV_FILTER_REJECT_SHED_REPEAT,  //!< Payload was already forwarded, load shed.
+    APP_ADV_FILTER_REJECT_SHED_RSSI,    //!< RSSI was below shed floor, load shed.
+    APP_ADV_FILTER_REJECT_QUEUE_FULL,   //!< Advertisement pool had no room.
+    APP_ADV_FILTER_REJECT_STALE,        //!< Advertisement waited too long to be forwarded.
+    APP_ADV_FILTER_REASON_NUM           //!< Number of reasons, not a valid reason.
+} app_adv_filter_reason_t;
+
+/**
+ * @brief Load shedding level, each level includes the ones below it.
+ */
+typedef enum
+{
+    APP_ADV_FILTER_SHED_NONE = 0, //!< Forward everything that passes filter.
+    APP_ADV_FILTER_SHED_REPEAT,   //!< Drop payload already forwarded for the tag.
+    APP_ADV_FILTER_SHED_WEAK,     //!< Drop advertisements below APP_ADV_SHED_RSSI_DBM.
+    APP_ADV_FILTER_SHED_NARROW    //!< Scan one PHY only.
+} app_adv_filter_shed_t;
+
+/**
+ * @brief Update cached manufacturer filter.
+ *
+ * @param[in] enabled True to accept only given manufacturer ID.
+ * @param[in] manufacturer_id Manufacturer ID to accept, e.g. 0x0499 for Ruuvi.
+ */
+void app_adv_filter_manufacturer_set (const bool enabled, const uint16_t manufacturer_id);
+
+/**
+ * @brief Set manufacturer IDs accepted in addition to the one given to
+ *        @ref app_adv_filter_manufacturer_set.
+ *
+ * Has effect only while manufacturer filter is enabled.
+ *
+ * @param[in] p_ids Extra manufacturer IDs, may be NULL if count is 0.
+ * @param[in] count Number of extra IDs, 0 to accept only the scan parameter ID.
+ * @param[in] accept_none True to also accept advertisements which have no
+ *                        manufacturer specific data.
+ * @retval RD_SUCCESS On success.
+ * @retval RD_ERROR_NULL If p_ids was NULL and count was not 0.
+ * @retval RD_ERROR_INVALID_PARAM If count exceeds APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX.
+ */
+rd_status_t app_adv_filter_manufacturer_extra_set (const uint16_t * const p_ids,
+        const size_t count, const bool accept_none);
+
+/**
+ * @brief Set duplicate suppression window.
+ *
+ * @param[in] window_ms Drop a tag's payload if it was forwarded within this time,
+ *                      0 to disable suppression.
+ */
+void app_adv_filter_dedup_window_set (const uint16_t window_ms);
+
+/**
+ * @brief Set per-tag rate limit.
+ *
+ * @param[in] interval_ms Minimum time between forwarded reports of one tag,
+ *                        0 to disable rate limit.
+ * @retval RD_SUCCESS on success.
+ * @retval RD_ERROR_INVALID_PARAM If interval_ms exceeds APP_ADV_FILTER_RATE_LIMIT_MAX_MS,
+ *                                previous interval stays.
+ */
+rd_status_t app_adv_filter_rate_limit_set (const uint16_t interval_ms);
+
+/**
+ * @brief Set RSSI floor.
+ *
+ * @param[in] floor_dbm Lowest RSSI to forward, INT8_MIN to disable floor.
+ * @param[in] hysteresis_db Tag in range is kept until RSSI drops below
+ *                          floor_dbm - hysteresis_db, 0 for no hysteresis.
+ */
+void app_adv_filter_rssi_floor_set (const int8_t floor_dbm, const uint8_t hysteresis_db);
+
+/**
+ * @brief Check a scanned advertisement against the filter.
+ *
+ * Safe to call from interrupt context. Rejections are counted by reason.
+ *
+ * @param[in] p_scan Scan result from BLE advertisement module.
+ * @param[in] data_len Size of event data, must be sizeof (ri_adv_scan_t).
+ * @return APP_ADV_FILTER_ACCEPT if advertisement should be processed,
+ *         reason of rejection otherwise.
+ */
+app_adv_filter_reason_t app_adv_filter_check (const ri_adv_scan_t * const p_scan,
+        const size_t data_len);
+
+/**
+ * @brief Record the advertisement last accepted by @ref app_adv_filter_check
+ *        as forwarded.
+ *
+ * Call from scan ISR once the advertisement is stored for forwarding. Until then
+ * duplicate suppression and rate limit do not count it, so an advertisement
+ * dropped on a full pool does not suppress the next copy of the payload.
+ */
+void app_adv_filter_commit (void);
+
+/**
+ * @brief Get load shedding level for current advertisement pool fill.
+ */
+app_adv_filter_shed_t app_adv_filter_shed_level_get (void);
+
+/**
+ * @brief Get highest load shedding level applied since previous call.
+ *
+ * Meant to be called once per scan window, peak is restarted from current level.
+ *
+ * @return Highest level applied by @ref app_adv_filter_check since previous call.
+ */
+app_adv_filter_shed_t app_adv_filter_shed_peak_take (void);
+
+/**
+ * @brief Count a rejection detected outside of the filter, e.g. full queue.
+ *
+ * @param[in] reason Reason of rejection.
+ */
+void app_adv_filter_reject (const app_adv_filter_reason_t reason);
+
+/**
+ * @brief Get number of advertisements rejected for given reason since reset.
+ *
+ * @param[in] reason Reason of rejection.
+ * @return Number of rejections, 0 for APP_ADV_FILTER_ACCEPT or invalid reason.
+ */
+uint32_t app_adv_filter_rejects_get (const app_adv_filter_reason_t reason);
+
+/**
+ * @brief Reset rejection counters.
+ */
+void app_adv_filter_rejects_reset (void);
+
+#endif
@@ -0,0 +1,181 @@
+/**
+ *  @file app_adv_match.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Payload match filter programmed by host.
+ */
+
+#include "app_adv_match.h"
+#include <string.h>
+
+#define APP_ADV_MATCH_LEN_MASK (0x7FFFU) //!< Program length bits of state.
+#define APP_ADV_MATCH_SET_POS  (15U)     //!< Active buffer bit of state.
+
+_Static_assert ((APP_ADV_MATCH_PROGRAM_MAX % APP_ADV_MATCH_INSTR_LEN) == 0U,
+                "APP_ADV_MATCH_PROGRAM_MAX must hold whole instructions");
+_Static_assert (APP_ADV_MATCH_PROGRAM_MAX <= APP_ADV_MATCH_LEN_MASK,
+                "APP_ADV_MATCH_PROGRAM_MAX must fit state");
+
+static uint8_t m_programs[2][APP_ADV_MATCH_PROGRAM_MAX];
+/** @brief Active buffer and program length packed into one halfword. */
+static volatile uint16_t m_state;
+
+/**
+ * @brief Find data of first AD structure of given type.
+ *
+ * @param[out] p_start Offset of AD data.
+ * @param[out] p_end Offset one past AD data.
+ * @return True if structure was found.
+ */
+static bool app_adv_match_ad_find (const uint8_t * const p_data, const size_t data_len,
+                                   const uint8_t type, size_t * const p_start,
+                                   size_t * const p_end)
+{
+    bool is_found = false;
+    size_t offset = 0;
+
+    // AD structure is length, type, data. Length counts type and data.
+    while (!is_found && ((offset + 1U) < data_len) && (0U != p_data[offset]))
+    {
+        const size_t next = offset + (size_t) p_data[offset] + 1U;
+
+        if ((type == p_data[offset + 1U]) && (next <= data_len))
+        {
+            *p_start = offset + 2U;
+            *p_end = next;
+            is_found = true;
+        }
+
+        offset = next;
+    }
+
+    return is_found;
+}
+
+/**
+ * @brief Run one instruction.
+ *
+ * @param[in] p_instr Instruction.
+ * @param[in] p_data Advertisement payload.
+ * @param[in] data_len Length of payload.
+ * @param[in,out] p_cursor Start of bytes checked by APP_ADV_MATCH_OP_BYTE.
+ * @param[in,out] p_end End of bytes checked by APP_ADV_MATCH_OP_BYTE.
+ * @return True if instruction matches.
+ */
+static bool app_adv_match_step (const uint8_t * const p_instr,
+                                const uint8_t * const p_data, const size_t data_len,
+                                size_t * const p_cursor, size_t * const p_end)
+{
+    bool is_match = false;
+
+    switch (p_instr[0])
+    {
+        case APP_ADV_MATCH_OP_LEN:
+            is_match = (p_instr[1] <= data_len) && (p_instr[2] >= data_len);
+            break;
+
+        case APP_ADV_MATCH_OP_AD_TYPE:
+            is_match = app_adv_match_ad_find (p_data, data_len, p_instr[1], p_cursor, p_end);
+            break;
+
+        case APP_ADV_MATCH_OP_BYTE:
+            is_match = ((*p_cursor + p_instr[1]) < *p_end)
+                       && ((p_data[*p_cursor + p_instr[1]] & p_instr[3]) == p_instr[2]);
+            break;
+
+        default:
+            // Programs are validated when set.
+            break;
+    }
+
+    return is_match;
+}
+
+rd_status_t app_adv_match_program_set (const uint8_t * const p_program, const size_t len)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((NULL == p_program) && (0U < len))
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if (APP_ADV_MATCH_PROGRAM_MAX < len)
+    {
+        err_code |= RD_ERROR_DATA_SIZE;
+    }
+    else if (0U != (len % APP_ADV_MATCH_INSTR_LEN))
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        bool is_rule_empty = true;
+
+        for (size_t pc = 0; (pc < len) && (RD_SUCCESS == err_code);
+                pc += APP_ADV_MATCH_INSTR_LEN)
+        {
+            const uint8_t op = p_program[pc];
+
+            if ((APP_ADV_MATCH_OP_NUM <= op)
+                    || ((APP_ADV_MATCH_OP_OR == op) && is_rule_empty))
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+
+            is_rule_empty = (APP_ADV_MATCH_OP_OR == op);
+        }
+
+        if ((0U < len) && is_rule_empty)
+        {
+            err_code |= RD_ERROR_INVALID_PARAM;
+        }
+    }
+
+    if (RD_SUCCESS == err_code)
+    {
+        const uint16_t next = (0U == (m_state >> APP_ADV_MATCH_SET_POS)) ? 1U : 0U;
+
+        if (0U < len)
+        {
+            memcpy (m_programs[next], p_program, len);
+        }
+
+        m_state = (uint16_t) ((next << APP_ADV_MATCH_SET_POS) | (uint16_t) len);
+    }
+
+    return err_code;
+}
+
+bool app_adv_match_check (const uint8_t * const p_data, const size_t data_len)
+{
+    const uint16_t state = m_state;
+    const size_t len = state & APP_ADV_MATCH_LEN_MASK;
+    const uint8_t * const p_program = m_programs[state >> APP_ADV_MATCH_SET_POS];
+    bool is_match = false;
+    bool is_rule_match = true;
+    size_t cursor = 0;
+    size_t end = data_len;
+
+    for (size_t pc = 0; (pc < len) && !is_match; pc += APP_ADV_MATCH_INSTR_LEN)
+    {
+        if (APP_ADV_MATCH_OP_OR == p_program[pc])
+        {
+            is_match = is_rule_match;
+            is_rule_match = true;
+            cursor = 0;
+            end = data_len;
+        }
+        else if (is_rule_match)
+        {
+            is_rule_match = app_adv_match_step (&p_program[pc], p_data, data_len, &cursor,
+                                                &end);
+        }
+        else
+        {
+            // Rule has failed, skip to next one.
+        }
+    }
+
+    return is_match || is_rule_match;
+}
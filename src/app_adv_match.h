@@ -0,0 +1,70 @@
+#ifndef APP_ADV_MATCH_H
+#define APP_ADV_MATCH_H
+
+/**
+ *  @file app_adv_match.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Payload match filter programmed by host.
+ *
+ *  Program is a list of 4-byte instructions [op, arg0, arg1, arg2]. Instructions
+ *  between @ref APP_ADV_MATCH_OP_OR separators form a rule, rule matches if all
+ *  its instructions match. Program matches if any rule matches, empty program
+ *  matches everything.
+ *
+ *  Byte checks are relative to a cursor, which is the start of payload at the
+ *  beginning of each rule and the start of AD data after
+ *  @ref APP_ADV_MATCH_OP_AD_TYPE. For example Ruuvi data formats 5 and E1 are
+ *  matched by
+ *  AD_TYPE 0xFF, BYTE 2 0x05 0xFF, OR, AD_TYPE 0xFF, BYTE 2 0xE1 0xFF.
+ *
+ *  Program is validated when set and double buffered, so ISR never runs a
+ *  half-written program.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app_config.h"
+#include "ruuvi_driver_error.h"
+
+#define APP_ADV_MATCH_INSTR_LEN (4U) //!< Bytes in one instruction.
+
+/**
+ * @brief Match program operations.
+ */
+typedef enum
+{
+    APP_ADV_MATCH_OP_OR = 0,      //!< End of rule, args unused.
+    APP_ADV_MATCH_OP_LEN = 1,     //!< [min, max] payload length is within range.
+    APP_ADV_MATCH_OP_AD_TYPE = 2, //!< [type] payload has AD structure, cursor to its data.
+    APP_ADV_MATCH_OP_BYTE = 3,    //!< [offset, value, mask] byte at cursor + offset.
+    APP_ADV_MATCH_OP_NUM          //!< Number of operations, not a valid operation.
+} app_adv_match_op_t;
+
+/**
+ * @brief Set match program.
+ *
+ * @param[in] p_program Instructions, may be NULL if len is 0.
+ * @param[in] len Length of program in bytes, 0 to match everything.
+ * @retval RD_SUCCESS On success.
+ * @retval RD_ERROR_NULL If p_program was NULL and len was not 0.
+ * @retval RD_ERROR_DATA_SIZE If program is longer than APP_ADV_MATCH_PROGRAM_MAX.
+ * @retval RD_ERROR_INVALID_PARAM If program has a partial or unknown instruction
+ *                                or an empty rule. Previous program stays in use.
+ */
+rd_status_t app_adv_match_program_set (const uint8_t * const p_program, const size_t len);
+
+/**
+ * @brief Run match program on advertisement payload.
+ *
+ * Safe to call from interrupt context.
+ *
+ * @param[in] p_data Advertisement payload.
+ * @param[in] data_len Length of payload.
+ * @return True if payload matches program.
+ */
+bool app_adv_match_check (const uint8_t * const p_data, const size_t data_len);
+
+#endif
@@ -0,0 +1,318 @@
+/**
+ *  @file app_adv_pool.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Pool of scanned advertisements waiting to be forwarded.
+ */
+
+#include "app_adv_pool.h"
+#include <stddef.h>
+#include <string.h>
+
+#define APP_ADV_POOL_PAD   (0U) //!< Record length of pad at end of ring.
+
+/**
+ * @brief Header of one record, followed by data_len bytes of data.
+ */
+typedef struct
+{
+    uint16_t len;          //!< Length of record including header, APP_ADV_POOL_PAD for pad.
+    uint8_t addr[BLE_MAC_ADDRESS_LENGTH]; //!< MAC address of advertiser.
+    int8_t rssi;           //!< RSSI of advertisement.
+    uint8_t data_len;      //!< Length of data.
+    bool is_coded_phy;     //!< True if advertisement was received on coded PHY.
+    uint8_t primary_phy;   //!< Primary PHY.
+    uint8_t secondary_phy; //!< Secondary PHY.
+    uint8_t ch_index;      //!< Channel index.
+    int8_t tx_power;       //!< TX power of advertiser.
+    app_clock_stamp_t rx;  //!< Reception time.
+} app_adv_pool_record_t;
+
+// Pad marker is only the len field, a pad is at least APP_ADV_POOL_ALIGN bytes.
+_Static_assert (offsetof (app_adv_pool_record_t, len) == 0U, "Pad marker must come first");
+_Static_assert (sizeof (app_adv_pool_record_t) == APP_ADV_POOL_RECORD_HEADER_LEN,
+                "APP_ADV_POOL_RECORD_HEADER_LEN must match record header");
+
+#define APP_ADV_POOL_BUCKET_SIZE (APP_ADV_POOL_SIZE / APP_ADV_POOL_BUCKETS) //!< Ring size.
+
+_Static_assert ((APP_ADV_POOL_BUCKETS & (APP_ADV_POOL_BUCKETS - 1U)) == 0U,
+                "APP_ADV_POOL_BUCKETS must be a power of two");
+_Static_assert ((APP_ADV_POOL_BUCKET_SIZE & (APP_ADV_POOL_BUCKET_SIZE - 1U)) == 0U,
+                "APP_ADV_POOL_SIZE must be a power of two");
+_Static_assert ((APP_ADV_POOL_BUCKET_SIZE % APP_ADV_POOL_ALIGN) == 0U,
+                "Bucket must hold whole aligned records");
+_Static_assert (RE_CA_UART_ADV_BYTES <= UINT8_MAX, "Record data_len must fit uint8_t");
+_Static_assert (APP_ADV_POOL_BUCKET_SIZE >= (2U * APP_ADV_POOL_QUANTUM),
+                "Empty bucket must fit largest record after a pad");
+
+/**
+ * @brief Single-producer single-consumer ring of records from one hash bucket.
+ */
+typedef struct
+{
+    uint8_t ring[APP_ADV_POOL_BUCKET_SIZE] __attribute__ ((aligned (APP_ADV_POOL_ALIGN)));
+    uint32_t head;    //!< Bytes written, free running, only producer writes.
+    uint32_t tail;    //!< Bytes released, free running, only consumer writes.
+    uint32_t deficit; //!< Bytes bucket may still forward this round, consumer only.
+} app_adv_pool_bucket_t;
+
+static app_adv_pool_bucket_t m_buckets[APP_ADV_POOL_BUCKETS];
+/** @brief Bucket whose round it is, consumer only. */
+static uint8_t m_turn;
+
+static size_t app_adv_pool_record_len (const size_t data_len)
+{
+    const size_t len = sizeof (app_adv_pool_record_t) + data_len;
+    return (len + APP_ADV_POOL_ALIGN - 1U) & ~ (size_t) (APP_ADV_POOL_ALIGN - 1U);
+}
+
+/**
+ * @brief Check if a record fits into a bucket.
+ *
+ * @param[in] head Head of bucket.
+ * @param[in] tail Tail of bucket.
+ * @param[in] len Length of record.
+ * @param[out] p_pad Bytes to pad at end of ring before the record.
+ * @return True if record and pad fit.
+ */
+static bool app_adv_pool_fits (const uint32_t head, const uint32_t tail, const size_t len,
+                               size_t * const p_pad)
+{
+    const size_t pos = head & (APP_ADV_POOL_BUCKET_SIZE - 1U);
+    // Record must be contiguous, pad the end of ring if it does not fit there.
+    *p_pad = ((APP_ADV_POOL_BUCKET_SIZE - pos) < len) ? (APP_ADV_POOL_BUCKET_SIZE - pos) : 0U;
+    return (APP_ADV_POOL_BUCKET_SIZE - (head - tail)) >= (*p_pad + len);
+}
+
+/**
+ * @brief Select bucket of a MAC address.
+ *
+ * Records of one tag always share a bucket, so a tag's records stay in order.
+ */
+static app_adv_pool_bucket_t * app_adv_pool_bucket (const uint8_t * const p_addr)
+{
+    uint8_t hash = 0;
+
+    for (size_t ii = 0; ii < BLE_MAC_ADDRESS_LENGTH; ii++)
+    {
+        hash ^= p_addr[ii];
+    }
+
+    hash ^= (uint8_t) (hash >> 4U);
+    return &m_buckets[hash & (APP_ADV_POOL_BUCKETS - 1U)];
+}
+
+/**
+ * @brief Get oldest record of a bucket, skipping a pad at end of ring.
+ *
+ * @param[in] p_bucket Bucket to read.
+ * @param[out] p_tail Tail of record.
+ * @return Oldest record, NULL if bucket is empty.
+ */
+static const app_adv_pool_record_t * app_adv_pool_peek (const app_adv_pool_bucket_t *
+        const p_bucket, uint32_t * const p_tail)
+{
+    uint32_t tail = __atomic_load_n (&p_bucket->tail, __ATOMIC_RELAXED);
+    // Acquire: record is visible once its head is.
+    const uint32_t head = __atomic_load_n (&p_bucket->head, __ATOMIC_ACQUIRE);
+    const app_adv_pool_record_t * p_record = NULL;
+
+    if (head != tail)
+    {
+        p_record = (const app_adv_pool_record_t *)
+                   &p_bucket->ring[tail & (APP_ADV_POOL_BUCKET_SIZE - 1U)];
+
+        if (APP_ADV_POOL_PAD == p_record->len)
+        {
+            tail += APP_ADV_POOL_BUCKET_SIZE - (tail & (APP_ADV_POOL_BUCKET_SIZE - 1U));
+            p_record = (const app_adv_pool_record_t *) &p_bucket->ring[0];
+        }
+    }
+
+    *p_tail = tail;
+    return p_record;
+}
+
+/**
+ * @brief Pass the round to next bucket and grant it a quantum.
+ */
+static void app_adv_pool_turn_next (void)
+{
+    m_turn = (uint8_t) ((m_turn + 1U) & (APP_ADV_POOL_BUCKETS - 1U));
+    m_buckets[m_turn].deficit += APP_ADV_POOL_QUANTUM;
+}
+
+void app_adv_pool_init (void)
+{
+    for (size_t ii = 0; ii < APP_ADV_POOL_BUCKETS; ii++)
+    {
+        __atomic_store_n (&m_buckets[ii].head, 0U, __ATOMIC_RELEASE);
+        __atomic_store_n (&m_buckets[ii].tail, 0U, __ATOMIC_RELEASE);
+        m_buckets[ii].deficit = 0;
+    }
+
+    m_turn = 0;
+    m_buckets[m_turn].deficit = APP_ADV_POOL_QUANTUM;
+}
+
+rd_status_t app_adv_pool_put (const ri_adv_scan_t * const p_scan,
+                              const app_clock_stamp_t * const p_rx)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (NULL == p_scan)
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if (RE_CA_UART_ADV_BYTES < p_scan->data_len)
+    {
+        err_code |= RD_ERROR_DATA_SIZE;
+    }
+    else
+    {
+        app_adv_pool_bucket_t * const p_bucket = app_adv_pool_bucket (p_scan->addr);
+        uint32_t head = __atomic_load_n (&p_bucket->head, __ATOMIC_RELAXED);
+        // Acquire: consumer has finished reading the space it released.
+        const uint32_t tail = __atomic_load_n (&p_bucket->tail, __ATOMIC_ACQUIRE);
+        const size_t len = app_adv_pool_record_len (p_scan->data_len);
+        size_t pad = 0;
+
+        if (!app_adv_pool_fits (head, tail, len, &pad))
+        {
+            err_code |= RD_ERROR_NO_MEM;
+        }
+        else
+        {
+            app_adv_pool_record_t * p_record;
+
+            if (0U < pad)
+            {
+                p_record = (app_adv_pool_record_t *)
+                           &p_bucket->ring[head & (APP_ADV_POOL_BUCKET_SIZE - 1U)];
+                p_record->len = APP_ADV_POOL_PAD;
+                head += (uint32_t) pad;
+            }
+
+            p_record = (app_adv_pool_record_t *)
+                       &p_bucket->ring[head & (APP_ADV_POOL_BUCKET_SIZE - 1U)];
+            p_record->len = (uint16_t) len;
+            p_record->rx = *p_rx;
+            memcpy (p_record->addr, p_scan->addr, sizeof (p_record->addr));
+            p_record->rssi = p_scan->rssi;
+            p_record->data_len = (uint8_t) p_scan->data_len;
+            p_record->is_coded_phy = p_scan->is_coded_phy;
+            p_record->primary_phy = p_scan->primary_phy;
+            p_record->secondary_phy = p_scan->secondary_phy;
+            p_record->ch_index = p_scan->ch_index;
+            p_record->tx_power = p_scan->tx_power;
+            memcpy (&p_record[1], p_scan->data, p_scan->data_len);
+            // Release: record is written before consumer can see it.
+            __atomic_store_n (&p_bucket->head, head + (uint32_t) len, __ATOMIC_RELEASE);
+        }
+    }
+
+    return err_code;
+}
+
+bool app_adv_pool_is_empty (void)
+{
+    bool is_empty = true;
+
+    for (size_t ii = 0; (ii < APP_ADV_POOL_BUCKETS) && is_empty; ii++)
+    {
+        is_empty = (__atomic_load_n (&m_buckets[ii].head, __ATOMIC_ACQUIRE)
+                    == __atomic_load_n (&m_buckets[ii].tail, __ATOMIC_RELAXED));
+    }
+
+    return is_empty;
+}
+
+uint32_t app_adv_pool_used_get (void)
+{
+    uint32_t used = 0;
+
+    for (size_t ii = 0; ii < APP_ADV_POOL_BUCKETS; ii++)
+    {
+        // Tail first: head loaded later can only be further ahead, result never wraps.
+        const uint32_t tail = __atomic_load_n (&m_buckets[ii].tail, __ATOMIC_ACQUIRE);
+        used += __atomic_load_n (&m_buckets[ii].head, __ATOMIC_ACQUIRE) - tail;
+    }
+
+    return used;
+}
+
+uint8_t app_adv_pool_fill_get (void)
+{
+    const size_t max_len = app_adv_pool_record_len (RE_CA_UART_ADV_BYTES);
+    // Bucket may refuse a largest record once less than that is free.
+    const uint32_t capacity = APP_ADV_POOL_BUCKET_SIZE - max_len;
+    uint32_t fill = 0;
+
+    for (size_t ii = 0; (ii < APP_ADV_POOL_BUCKETS) && (100U > fill); ii++)
+    {
+        const uint32_t tail = __atomic_load_n (&m_buckets[ii].tail, __ATOMIC_ACQUIRE);
+        const uint32_t head = __atomic_load_n (&m_buckets[ii].head, __ATOMIC_ACQUIRE);
+        const uint32_t used = head - tail;
+        size_t pad = 0;
+        // Pad and alignment waste leave a full bucket with some free bytes.
+        const uint32_t bucket_fill =
+            (app_adv_pool_fits (head, tail, max_len, &pad) && (used < capacity))
+            ? ((used * 100U) / capacity) : 100U;
+        fill = (bucket_fill > fill) ? bucket_fill : fill;
+    }
+
+    return (uint8_t) fill;
+}
+
+bool app_adv_pool_get (ri_adv_scan_t * const p_scan, app_clock_stamp_t * const p_rx)
+{
+    const app_adv_pool_record_t * p_record = NULL;
+    app_adv_pool_bucket_t * p_bucket = NULL;
+    uint32_t tail = 0;
+
+    memset (p_scan, 0, sizeof (*p_scan));
+
+    // Deficit round-robin: a bucket forwards up to its deficit, then passes the round.
+    // A bucket getting its turn has at least one quantum, so a round of turns ends
+    // in a record unless all buckets are empty.
+    for (size_t turns = 0; (NULL == p_record) && (turns <= APP_ADV_POOL_BUCKETS); turns++)
+    {
+        p_bucket = &m_buckets[m_turn];
+        p_record = app_adv_pool_peek (p_bucket, &tail);
+
+        if (NULL == p_record)
+        {
+            // Idle bucket does not bank credit.
+            p_bucket->deficit = 0;
+            app_adv_pool_turn_next();
+        }
+        else if (p_bucket->deficit < p_record->len)
+        {
+            p_record = NULL;
+            app_adv_pool_turn_next();
+        }
+        else
+        {
+            p_bucket->deficit -= p_record->len;
+        }
+    }
+
+    if (NULL != p_record)
+    {
+        *p_rx = p_record->rx;
+        memcpy (p_scan->addr, p_record->addr, sizeof (p_record->addr));
+        p_scan->rssi = p_record->rssi;
+        p_scan->data_len = p_record->data_len;
+        p_scan->is_coded_phy = p_record->is_coded_phy;
+        p_scan->primary_phy = p_record->primary_phy;
+        p_scan->secondary_phy = p_record->secondary_phy;
+        p_scan->ch_index = p_record->ch_index;
+        p_scan->tx_power = p_record->tx_power;
+        memcpy (p_scan->data, &p_record[1], p_record->data_len);
+        // Release: record is read before producer can overwrite it.
+        __atomic_store_n (&p_bucket->tail, tail + p_record->len, __ATOMIC_RELEASE);
+    }
+
+    return (NULL != p_record);
+}
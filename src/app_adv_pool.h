@@ -0,0 +1,106 @@
+#ifndef APP_ADV_POOL_H
+#define APP_ADV_POOL_H
+
+/**
+ *  @file app_adv_pool.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Pool of scanned advertisements waiting to be forwarded.
+ *
+ *  Advertisements are stored as variable-length records in a byte ring,
+ *  each record takes a small header and data_len bytes of payload instead of
+ *  a whole ri_adv_scan_t. A record which does not fit before the end of the
+ *  ring is placed at the start, leaving a pad marker behind.
+ *
+ *  Pool is split into APP_ADV_POOL_BUCKETS rings by a hash of advertiser MAC
+ *  address. Records are taken from the buckets in deficit round-robin order:
+ *  on its turn a bucket may forward one largest record worth of bytes, so each
+ *  bucket gets an equal share of UART bandwidth under contention, however
+ *  chatty the devices in other buckets are. A device filling its bucket does
+ *  not take space from other buckets either. Records of one tag share a bucket
+ *  and stay in order.
+ *
+ *  Each bucket is a wait-free single-producer single-consumer channel: scan
+ *  ISR is the only writer and main context the only reader. Each side owns one
+ *  free-running index and publishes it with release ordering after the record
+ *  has been written or read, the other side loads it with acquire ordering.
+ *  On Cortex-M4 this puts a DMB between record access and index update, so
+ *  no critical section is needed.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_clock.h"
+#include "app_config.h"
+#include "ruuvi_driver_error.h"
+#include "ruuvi_endpoint_ca_uart.h"
+#include "ruuvi_interface_communication_ble_advertising.h"
+
+#define APP_ADV_POOL_ALIGN (4U) //!< Record alignment in ring.
+#define APP_ADV_POOL_RECORD_HEADER_LEN (24U) //!< Bytes of record header before data.
+
+/** @brief Bytes a bucket may forward per round, fits the largest record. */
+#define APP_ADV_POOL_QUANTUM \
+    (APP_ADV_POOL_RECORD_HEADER_LEN + RE_CA_UART_ADV_BYTES + APP_ADV_POOL_ALIGN)
+
+/**
+ * @brief Empty the pool.
+ *
+ * Must not run concurrently with @ref app_adv_pool_put.
+ */
+void app_adv_pool_init (void);
+
+/**
+ * @brief Store an advertisement.
+ *
+ * Call from scan ISR only.
+ *
+ * @param[in] p_scan Advertisement to store.
+ * @param[in] p_rx Reception time of advertisement, kept to track its age.
+ * @retval RD_SUCCESS If advertisement was stored.
+ * @retval RD_ERROR_NULL If p_scan was NULL.
+ * @retval RD_ERROR_DATA_SIZE If advertisement data does not fit a record.
+ * @retval RD_ERROR_NO_MEM If bucket of advertiser is full.
+ */
+rd_status_t app_adv_pool_put (const ri_adv_scan_t * const p_scan,
+                              const app_clock_stamp_t * const p_rx);
+
+/**
+ * @brief Take the oldest advertisement of the bucket whose turn it is.
+ *
+ * Call from main context only.
+ *
+ * @param[out] p_scan Advertisement, fields not stored in pool are zeroed.
+ * @param[out] p_rx Reception time given to @ref app_adv_pool_put.
+ * @return True if an advertisement was taken, false if pool was empty.
+ */
+bool app_adv_pool_get (ri_adv_scan_t * const p_scan, app_clock_stamp_t * const p_rx);
+
+/**
+ * @brief Check if pool has no advertisements.
+ *
+ * Call from main context only.
+ */
+bool app_adv_pool_is_empty (void);
+
+/**
+ * @brief Get number of pool bytes in use, including record headers and padding.
+ *
+ * Safe to call from either context, value may be outdated by the time it is used.
+ */
+uint32_t app_adv_pool_used_get (void);
+
+/**
+ * @brief Get pool fill in percent of the fullest bucket.
+ *
+ * A chatty advertiser runs out of its own bucket long before the pool as a
+ * whole fills up, so fill follows the bucket closest to dropping data. A bucket
+ * which cannot take a largest advertisement counts as full, so fill is scaled
+ * to bucket size less one largest record and reaches 100% even though pads and
+ * alignment leave bytes unused.
+ * Safe to call from either context, value may be outdated by the time it is used.
+ */
+uint8_t app_adv_pool_fill_get (void);
+
+#endif
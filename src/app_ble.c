@@ -8,7 +8,14 @@
  */
 
 #include "app_ble.h"
+#include "app_config.h"
 #include <string.h>
+#include "app_adv_filter.h"
+#include "app_adv_pool.h"
+#include "app_clock.h"
+#include "app_latency.h"
+#include "app_scan_schedule.h"
+#include "app_stats.h"
 #include "app_uart.h"
 #include "ruuvi_driver_error.h"
 #include "ruuvi_boards.h"
@@ -17,7 +24,7 @@
 #include "ruuvi_interface_communication_radio.h"
 #include "ruuvi_interface_communication_ble_advertising.h"
 #include "ruuvi_interface_gpio.h"
-#include "ruuvi_interface_scheduler.h"
+#include "ruuvi_interface_timer.h"
 #include "ruuvi_interface_watchdog.h"
 #include "ruuvi_task_advertisement.h"
 #include "ruuvi_task_led.h"
@@ -54,6 +61,17 @@ static inline bool scan_is_enabled (const app_ble_scan_t * const params)
            || params->modulation_2mbit_enabled;
 }
 
+static inline bool scan_is_dual_phy (const app_ble_scan_t * const params)
+{
+    return params->modulation_125kbps_enabled
+           && (params->modulation_1mbit_enabled || params->modulation_2mbit_enabled);
+}
+
+static inline bool scan_is_concurrent (const app_ble_scan_t * const params)
+{
+    return (APP_BLE_SCAN_MODE_CONCURRENT == params->scan_mode) && scan_is_dual_phy (params);
+}
+
 static app_ble_scan_t m_scan_params =
 {
     .manufacturer_id = RB_BLE_DEFAULT_MANUFACTURER_ID,
@@ -65,37 +83,181 @@ static app_ble_scan_t m_scan_params =
     .modulation_2mbit_enabled = RB_BLE_DEFAULT_2MBIT_STATE,
     .is_current_modulation_125kbps = false,
     .manufacturer_filter_enabled = RB_BLE_DEFAULT_FLTR_STATE,
+    .scan_mode = APP_BLE_SCAN_MODE_ALTERNATE,
 };
 
-#ifndef CEEDLING
-static
-#endif
-void repeat_adv (void * p_data, uint16_t data_len)
+/**
+ * @brief Scan window settings which take a radio restart to change.
+ */
+typedef struct
 {
-    rd_status_t err_code = RD_SUCCESS;
+    ri_radio_channels_t channels; //!< Primary channels scanned.
+    bool is_125kbps;              //!< Radio runs on coded PHY.
+    bool is_concurrent;           //!< Coded PHY session listens on 1M PHY too.
+    bool is_scheduled;            //!< Window runs an app_scan_schedule entry.
+    uint16_t schedule_ms;         //!< Length of schedule entry.
+} app_ble_window_t;
+
+/**
+ * @brief Running scan session was started with current parameters.
+ *
+ * Cleared on parameter changes so that next window restarts radio with them.
+ */
+static bool m_is_scan_current;
+
+/** @brief Window of running scan session. */
+static app_ble_window_t m_scan_window;
+
+static ri_timer_id_t m_schedule_timer;    //!< Ends schedule entries.
+static bool m_is_schedule_entry_running;  //!< Schedule timer runs for current entry.
+static uint32_t m_schedule_entry_ms;      //!< Start of current schedule entry.
+static ri_timer_id_t m_window_timer;      //!< Ends scan windows at host timeout.
+static bool m_is_window_timer_running;    //!< Window timer runs for current window.
+
+/**
+ * @brief Traffic-weighted split of alternating scan windows between PHYs.
+ */
+typedef struct
+{
+    uint32_t rate_1m;    //!< Accepted advertisements per 1M PHY window, x16, averaged.
+    uint32_t rate_coded; //!< Accepted advertisements per coded PHY window, x16, averaged.
+    uint32_t window_rx;  //!< Accepted advertisements in running window.
+    uint8_t min_percent; //!< Lowest share of coded PHY windows.
+    uint8_t max_percent; //!< Highest share of coded PHY windows.
+    uint8_t credit;      //!< Accumulated coded PHY share, a coded window takes 100.
+} app_ble_phy_share_t;
+
+#define APP_BLE_PHY_SHARE_CREDIT_INIT (50U) //!< Equal shares start on coded PHY.
+#define APP_BLE_PHY_RATE_SCALE_SHIFT  (4U)  //!< Fixed point fraction bits of rates.
+#define APP_BLE_PHY_RATE_AVG_SHIFT    (3U)  //!< Rates follow traffic over ~8 windows.
+
+static app_ble_phy_share_t m_phy_share =
+{
+    .min_percent = APP_BLE_CODED_SHARE_MIN_PERCENT,
+    .max_percent = APP_BLE_CODED_SHARE_MAX_PERCENT,
+    .credit = APP_BLE_PHY_SHARE_CREDIT_INIT,
+};
 
-    if (sizeof (ri_adv_scan_t) == data_len)
+#define APP_BLE_CH_FIRST (37U) //!< First primary advertising channel.
+#define APP_BLE_CH_NUM   (3U)  //!< Number of primary advertising channels.
+
+/**
+ * @brief Yield-weighted split of scan windows between primary channels.
+ */
+typedef struct
+{
+    uint32_t rate[APP_BLE_CH_NUM];      //!< Accepted advertisements per window, x16, averaged.
+    uint32_t window_rx[APP_BLE_CH_NUM]; //!< Accepted advertisements in running window.
+    int32_t credit[APP_BLE_CH_NUM];     //!< Accumulated weight, a window takes sum of weights.
+    uint8_t min_percent;                //!< Lowest weight of an enabled channel.
+    uint8_t max_percent;                //!< Highest weight of an enabled channel.
+    bool is_adaptive;                   //!< Scan one channel per window, picked by yield.
+} app_ble_ch_share_t;
+
+static app_ble_ch_share_t m_ch_share =
+{
+    .min_percent = APP_BLE_CHANNEL_SHARE_MIN_PERCENT,
+    .max_percent = APP_BLE_CHANNEL_SHARE_MAX_PERCENT,
+};
+
+static rd_status_t scan_window_next (void);
+
+/** @brief Advertisements older than this are dropped, 0 to forward all. */
+static uint16_t m_adv_max_age_ms;
+static uint32_t m_adv_age_count;
+static uint64_t m_adv_age_sum_ms;
+static uint32_t m_adv_age_max_ms;
+
+bool app_ble_adv_forward (void)
+{
+    ri_adv_scan_t scan;
+    app_clock_stamp_t rx = {0};
+    uint32_t forwarded = 0;
+
+    // Leave advertisements in pool rather than drop them at a full TX queue.
+    while ((APP_BLE_ADV_FORWARD_BUDGET > forwarded) && (!app_uart_tx_queue_is_full())
+            && app_adv_pool_get (&scan, &rx))
     {
-        err_code |= app_uart_send_broadcast ((ri_adv_scan_t *) p_data);
+        const uint32_t age_ms = app_clock_ms_get() - rx.ms;
 
-        if (RD_SUCCESS == err_code)
+        // Fresh data beats a backlog of old readings.
+        if ((0U < m_adv_max_age_ms) && (m_adv_max_age_ms < age_ms))
         {
-            (void) ri_watchdog_feed();
+            app_adv_filter_reject (APP_ADV_FILTER_REJECT_STALE);
         }
+        else
+        {
+            m_adv_age_count++;
+            m_adv_age_sum_ms += age_ms;
+            m_adv_age_max_ms = (m_adv_age_max_ms < age_ms) ? age_ms : m_adv_age_max_ms;
+            app_latency_record_ticks (APP_LATENCY_STAGE_POOL,
+                                      app_clock_ticks_get() - rx.ticks);
+
+            if (RD_SUCCESS == app_uart_send_broadcast (&scan, rx.ticks))
+            {
+                (void) ri_watchdog_feed();
+            }
+        }
+
+        forwarded++;
+    }
+
+    return (APP_BLE_ADV_FORWARD_BUDGET <= forwarded) && (!app_adv_pool_is_empty());
+}
+
+void app_ble_adv_max_age_set (const uint16_t max_age_ms)
+{
+    m_adv_max_age_ms = max_age_ms;
+}
+
+void app_ble_adv_age_take (app_ble_adv_age_t * const p_age)
+{
+    p_age->count = m_adv_age_count;
+    p_age->mean_ms = (0U < m_adv_age_count)
+                     ? (uint32_t) (m_adv_age_sum_ms / m_adv_age_count) : 0U;
+    p_age->max_ms = m_adv_age_max_ms;
+    m_adv_age_count = 0;
+    m_adv_age_sum_ms = 0;
+    m_adv_age_max_ms = 0;
+}
+
+/** @brief Check if a primary channel, 0 for channel 37, is in channel mask. */
+static bool ch_is_enabled (const ri_radio_channels_t * const p_channels, const uint8_t ch)
+{
+    const bool is_enabled[APP_BLE_CH_NUM] =
+    {
+        (0U != p_channels->channel_37),
+        (0U != p_channels->channel_38),
+        (0U != p_channels->channel_39)
+    };
+    return is_enabled[ch];
+}
+
+/** @brief Count accepted advertisement to yield of its primary channel. */
+static void ch_share_rx (const ri_adv_scan_t * const p_scan)
+{
+    app_stats_ch_count (APP_STATS_ACCEPT_CH_37, p_scan);
+
+    if ((APP_BLE_CH_FIRST <= p_scan->ch_index)
+            && ((APP_BLE_CH_FIRST + APP_BLE_CH_NUM) > p_scan->ch_index))
+    {
+        m_ch_share.window_rx[p_scan->ch_index - APP_BLE_CH_FIRST]++;
     }
 }
 
 /**
  * @brief Handle Scan events.
  *
- * Received data is put to scheduler queue, new scan with new PHY is started on timeout.
+ * Received data is stored in app_adv_pool for @ref app_ble_adv_forward. On timeout
+ * next scan window is started, see @ref scan_window_next. Data rejected by
+ * @ref app_adv_filter_check is dropped without using pool space.
  *
  * @param[in] evt Type of event, either RI_COMM_RECEIVED on data or
  *                RI_COMM_TIMEOUT on scan timeout.
  * @param[in] p_data NULL on timeout, ri_adv_scan_t* on received.
  * @param[in] data_len 0 on timeout, size of ri_adv_scan_t on received.
  * @retval RD_SUCCESS on successful handling on event.
- * @retval RD_ERR_NO_MEM if received event could not be put to scheduler queue.
+ * @retval RD_ERR_NO_MEM if received data could not be stored.
  * @return Error code from scanning if scan cannot be started.
  *
  * @note parameters are not const to maintain compatibility with the event handler
@@ -108,17 +270,59 @@ rd_status_t on_scan_isr (const ri_comm_evt_t evt, void * p_data, // -V2009
                          size_t data_len)
 {
     rd_status_t err_code = RD_SUCCESS;
+    app_clock_stamp_t rx = {0};
+    app_adv_filter_reason_t reason = APP_ADV_FILTER_ACCEPT;
 
     switch (evt)
     {
         case RI_COMM_RECEIVED:
+            // Stamp before filtering, filter time is part of forwarding latency.
+            rx.ms = app_clock_ms_get();
+            rx.ticks = app_clock_ticks_get();
             LOGD ("DATA\r\n");
-            err_code |= ri_scheduler_event_put (p_data, (uint16_t) data_len, repeat_adv);
+
+            if (sizeof (ri_adv_scan_t) == data_len)
+            {
+                app_stats_rx_count (p_data);
+            }
+
+            // Drop unwanted data before it takes pool space.
+            reason = app_adv_filter_check (p_data, data_len);
+
+            if (APP_ADV_FILTER_ACCEPT == reason)
+            {
+                m_phy_share.window_rx++;
+                ch_share_rx (p_data);
+                err_code |= app_adv_pool_put (p_data, &rx);
+
+                if (RD_SUCCESS == err_code)
+                {
+                    app_adv_filter_commit();
+                }
+                else if (RD_ERROR_NO_MEM == err_code)
+                {
+                    app_adv_filter_reject (APP_ADV_FILTER_REJECT_QUEUE_FULL);
+                }
+                else
+                {
+                    // No action needed.
+                }
+            }
+            else if ((APP_ADV_FILTER_REJECT_INVALID == reason)
+                     && (sizeof (ri_adv_scan_t) == data_len))
+            {
+                app_stats_ch_count (APP_STATS_INVALID_CH_37, p_data);
+            }
+            else
+            {
+                // Filtered by content, counted by app_adv_filter.
+            }
+
             break;
 
         case RI_COMM_TIMEOUT:
             LOG ("Timeout\r\n");
-            err_code |= app_ble_scan_start();
+            err_code |= scan_window_next();
             break;
 
         default:
@@ -134,6 +338,9 @@ rd_status_t app_ble_manufacturer_filter_set (const bool state)
 {
     rd_status_t  err_code = RD_SUCCESS;
     m_scan_params.manufacturer_filter_enabled = state;
+    m_is_scan_current = false;
+    app_adv_filter_manufacturer_set (m_scan_params.manufacturer_filter_enabled,
+                                     m_scan_params.manufacturer_id);
     return err_code;
 }
 
@@ -147,6 +354,9 @@ rd_status_t app_ble_manufacturer_id_set (const uint16_t id)
 {
     rd_status_t  err_code = RD_SUCCESS;
     m_scan_params.manufacturer_id = id;
+    m_is_scan_current = false;
+    app_adv_filter_manufacturer_set (m_scan_params.manufacturer_filter_enabled,
+                                     m_scan_params.manufacturer_id);
     return err_code;
 }
 
@@ -172,6 +382,8 @@ rd_status_t app_ble_channels_set (const ri_radio_channels_t channels)
     else
     {
         m_scan_params.scan_channels = channels;
+        memset (m_ch_share.credit, 0, sizeof (m_ch_share.credit));
+        m_is_scan_current = false;
     }
 
     return err_code;
@@ -180,12 +392,14 @@ rd_status_t app_ble_channels_set (const ri_radio_channels_t channels)
 void app_ble_set_max_adv_len (uint8_t max_adv_length)
 {
     m_scan_params.max_adv_length = max_adv_length;
+    m_is_scan_current = false;
 }
 
 rd_status_t app_ble_modulation_enable (const ri_radio_modulation_t modulation,
                                        const bool enable)
 {
     rd_status_t err_code = RD_SUCCESS;
+    m_is_scan_current = false;
 
     switch (modulation)
     {
@@ -217,31 +431,348 @@ rd_status_t app_ble_modulation_enable (const ri_radio_modulation_t modulation,
     return err_code;
 }
 
-static inline void next_modulation_select (void)
+rd_status_t app_ble_phy_share_set (const uint8_t min_percent, const uint8_t max_percent)
 {
-    if (m_scan_params.is_current_modulation_125kbps)
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((min_percent > max_percent) || (100U < max_percent))
     {
-        if (m_scan_params.modulation_1mbit_enabled ||
-                m_scan_params.modulation_2mbit_enabled)
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        m_phy_share.min_percent = min_percent;
+        m_phy_share.max_percent = max_percent;
+        m_phy_share.rate_1m = 0;
+        m_phy_share.rate_coded = 0;
+        m_phy_share.window_rx = 0;
+        m_phy_share.credit = APP_BLE_PHY_SHARE_CREDIT_INIT;
+    }
+
+    return err_code;
+}
+
+rd_status_t app_ble_channel_dwell_set (const bool is_adaptive, const uint8_t min_percent,
+                                      const uint8_t max_percent)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((0U == min_percent) || (min_percent > max_percent) || (100U < max_percent))
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        m_ch_share.is_adaptive = is_adaptive;
+        m_ch_share.min_percent = min_percent;
+        m_ch_share.max_percent = max_percent;
+        memset (m_ch_share.rate, 0, sizeof (m_ch_share.rate));
+        memset (m_ch_share.window_rx, 0, sizeof (m_ch_share.window_rx));
+        memset (m_ch_share.credit, 0, sizeof (m_ch_share.credit));
+        m_is_scan_current = false;
+    }
+
+    return err_code;
+}
+
+/** @brief Check if scan windows are split between enabled channels. */
+static bool ch_share_is_active (void)
+{
+    uint8_t enabled = 0;
+
+    for (uint8_t ch = 0; ch < APP_BLE_CH_NUM; ch++)
+    {
+        enabled += ch_is_enabled (&m_scan_params.scan_channels, ch) ? 1U : 0U;
+    }
+
+    return m_ch_share.is_adaptive && (1U < enabled);
+}
+
+/**
+ * @brief Get weight of an enabled channel from yields, in percent.
+ *
+ * Channels are weighted in proportion to their advertisements per window,
+ * equally if none has traffic yet.
+ */
+static int32_t ch_share_weight_get (const uint8_t ch)
+{
+    uint32_t rate_sum = 0;
+    uint32_t weight = 100U / APP_BLE_CH_NUM;
+
+    for (uint8_t ii = 0; ii < APP_BLE_CH_NUM; ii++)
+    {
+        if (ch_is_enabled (&m_scan_params.scan_channels, ii))
         {
-            m_scan_params.is_current_modulation_125kbps = false;
+            rate_sum += m_ch_share.rate[ii];
         }
-        else
+    }
+
+    if (0U < rate_sum)
+    {
+        weight = (100U * m_ch_share.rate[ch]) / rate_sum;
+    }
+
+    if (m_ch_share.min_percent > weight)
+    {
+        weight = m_ch_share.min_percent;
+    }
+    else if (m_ch_share.max_percent < weight)
+    {
+        weight = m_ch_share.max_percent;
+    }
+    else
+    {
+        // No action needed.
+    }
+
+    return (int32_t) weight;
+}
+
+/**
+ * @brief Get channel of next window.
+ *
+ * Smooth weighted round-robin: the channel with most accumulated weight scans
+ * next, so channels get windows in proportion to their weights.
+ *
+ * @return Channel, 0 for channel 37.
+ */
+static uint8_t ch_share_next (void)
+{
+    uint8_t next = 0;
+    int32_t next_credit = INT32_MIN;
+
+    for (uint8_t ch = 0; ch < APP_BLE_CH_NUM; ch++)
+    {
+        if (ch_is_enabled (&m_scan_params.scan_channels, ch))
         {
-            // No action needed.
+            const int32_t credit = m_ch_share.credit[ch] + ch_share_weight_get (ch);
+
+            if (credit > next_credit)
+            {
+                next_credit = credit;
+                next = ch;
+            }
         }
     }
-    else
+
+    return next;
+}
+
+/**
+ * @brief Account a started window to channel credits.
+ *
+ * @param[in] p_channels Channels of started window.
+ */
+static void ch_share_window_start (const ri_radio_channels_t * const p_channels)
+{
+    if (ch_share_is_active())
     {
-        if (m_scan_params.modulation_125kbps_enabled)
+        int32_t weight_sum = 0;
+
+        for (uint8_t ch = 0; ch < APP_BLE_CH_NUM; ch++)
         {
-            m_scan_params.is_current_modulation_125kbps = true;
+            if (ch_is_enabled (&m_scan_params.scan_channels, ch))
+            {
+                const int32_t weight = ch_share_weight_get (ch);
+                m_ch_share.credit[ch] += weight;
+                weight_sum += weight;
+            }
         }
-        else
+
+        for (uint8_t ch = 0; ch < APP_BLE_CH_NUM; ch++)
         {
-            // No action needed.
+            if (ch_is_enabled (p_channels, ch))
+            {
+                m_ch_share.credit[ch] -= weight_sum;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fold advertisements of ended window into yields of its channels.
+ *
+ * @param[in] p_channels Channels of ended window.
+ */
+static void ch_share_window_end (const ri_radio_channels_t * const p_channels)
+{
+    for (uint8_t ch = 0; ch < APP_BLE_CH_NUM; ch++)
+    {
+        if (ch_is_enabled (p_channels, ch))
+        {
+            uint32_t * const p_rate = &m_ch_share.rate[ch];
+            const uint32_t window_rate = m_ch_share.window_rx[ch]
+                                         << APP_BLE_PHY_RATE_SCALE_SHIFT;
+            *p_rate = (*p_rate - (*p_rate >> APP_BLE_PHY_RATE_AVG_SHIFT))
+                      + (window_rate >> APP_BLE_PHY_RATE_AVG_SHIFT);
+        }
+
+        m_ch_share.window_rx[ch] = 0;
+    }
+}
+
+/**
+ * @brief Get share of windows for coded PHY from traffic, in percent.
+ *
+ * PHYs share windows in proportion to their advertisements per window, equally
+ * if neither has traffic yet.
+ */
+static uint8_t phy_share_coded_get (void)
+{
+    const uint32_t rate_sum = m_phy_share.rate_1m + m_phy_share.rate_coded;
+    uint32_t share = 50U;
+
+    if (0U < rate_sum)
+    {
+        share = (100U * m_phy_share.rate_coded) / rate_sum;
+    }
+
+    if (m_phy_share.min_percent > share)
+    {
+        share = m_phy_share.min_percent;
+    }
+    else if (m_phy_share.max_percent < share)
+    {
+        share = m_phy_share.max_percent;
+    }
+    else
+    {
+        // No action needed.
+    }
+
+    return (uint8_t) share;
+}
+
+/**
+ * @brief Fold advertisements of ended window into rate of its PHY.
+ *
+ * @param[in] is_125kbps True if window was on coded PHY.
+ */
+static void phy_share_window_end (const bool is_125kbps)
+{
+    uint32_t * const p_rate = is_125kbps ? &m_phy_share.rate_coded : &m_phy_share.rate_1m;
+    const uint32_t window_rate = m_phy_share.window_rx << APP_BLE_PHY_RATE_SCALE_SHIFT;
+    *p_rate = (*p_rate - (*p_rate >> APP_BLE_PHY_RATE_AVG_SHIFT))
+              + (window_rate >> APP_BLE_PHY_RATE_AVG_SHIFT);
+    m_phy_share.window_rx = 0;
+}
+
+/**
+ * @brief Account a started window to coded PHY share.
+ *
+ * @param[in] is_narrow True if window was narrowed to 1M PHY by load shedding.
+ * @param[in] is_125kbps True if window is on coded PHY.
+ */
+static void phy_share_window_start (const bool is_narrow, const bool is_125kbps)
+{
+    if (scan_is_dual_phy (&m_scan_params) && (!is_narrow))
+    {
+        uint32_t credit = (uint32_t) m_phy_share.credit + phy_share_coded_get();
+
+        // Bounds may be changed by host between window selection and this.
+        if (is_125kbps)
+        {
+            credit = (100U <= credit) ? (credit - 100U) : 0U;
         }
+
+        m_phy_share.credit = (uint8_t) ((UINT8_MAX < credit) ? UINT8_MAX : credit);
+    }
+}
+
+/**
+ * @brief Get PHY of next scan window.
+ *
+ * With both PHYs enabled coded PHY gets a window whenever its accumulated
+ * share covers one, see @ref phy_share_coded_get.
+ *
+ * @param[in] is_narrow True to stay on 1M PHY if enabled, sheds coded PHY load.
+ * @return True if next window is on coded PHY.
+ */
+static inline bool next_modulation_is_125kbps (const bool is_narrow)
+{
+    bool is_125kbps = m_scan_params.modulation_125kbps_enabled;
+
+    if (is_narrow && (m_scan_params.modulation_1mbit_enabled
+                      || m_scan_params.modulation_2mbit_enabled))
+    {
+        is_125kbps = false;
+    }
+    else if (scan_is_dual_phy (&m_scan_params))
+    {
+        is_125kbps = (100U <= ((uint32_t) m_phy_share.credit + phy_share_coded_get()));
+    }
+    else
+    {
+        // No action needed.
+    }
+
+    return is_125kbps;
+}
+
+/**
+ * @brief Check if host scan timing can be used in a scan mode.
+ *
+ * Concurrent scan splits each interval between both primary PHYs, SoftDevice
+ * refuses to start it unless interval is at least twice the window. Refused
+ * start would end scanning at the next re-arm.
+ */
+static bool scan_timing_fits_mode (const app_ble_scan_mode_t mode,
+                                   const uint16_t interval_ms, const uint16_t window_ms)
+{
+    return (APP_BLE_SCAN_MODE_CONCURRENT != mode) || (0U == interval_ms)
+           || ((2U * (uint32_t) window_ms) <= interval_ms);
+}
+
+rd_status_t app_ble_scan_mode_set (const app_ble_scan_mode_t mode)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (APP_BLE_SCAN_MODE_NUM <= mode)
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else if ((APP_BLE_SCAN_MODE_CONCURRENT == mode) && (!APP_BLE_CONCURRENT_PHY_SUPPORTED))
+    {
+        err_code |= RD_ERROR_NOT_SUPPORTED;
+    }
+    else if (!scan_timing_fits_mode (mode, m_scan_params.scan_interval_ms,
+                                     m_scan_params.scan_window_ms))
+    {
+        err_code |= RD_ERROR_INVALID_STATE;
+    }
+    else
+    {
+        m_scan_params.scan_mode = mode;
+        m_is_scan_current = false;
+    }
+
+    return err_code;
+}
+
+rd_status_t app_ble_scan_timing_set (const uint16_t interval_ms, const uint16_t window_ms,
+                                     const uint16_t timeout_ms)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (((0U == interval_ms) != (0U == window_ms))
+            || ((0U < interval_ms)
+                && ((APP_BLE_SCAN_INTERVAL_MIN_MS > window_ms)
+                    || (window_ms > interval_ms)
+                    || (APP_BLE_SCAN_INTERVAL_MAX_MS < interval_ms)))
+            || (!scan_timing_fits_mode (m_scan_params.scan_mode, interval_ms, window_ms))
+            || ((0U < timeout_ms) && (APP_BLE_SCAN_TIMEOUT_MIN_MS > timeout_ms)))
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        // Running scan stays current, next window re-arms with new timing.
+        m_scan_params.scan_interval_ms = interval_ms;
+        m_scan_params.scan_window_ms = window_ms;
+        m_scan_params.scan_timeout_ms = timeout_ms;
     }
+
+    return err_code;
 }
 
 static rd_status_t pa_lna_ctrl (void)
@@ -262,18 +793,202 @@ static rd_status_t pa_lna_ctrl (void)
     return err_code;
 }
 
-rd_status_t app_ble_scan_start (void)
+/**
+ * @brief Select next scan window.
+ *
+ * Uploaded schedule takes precedence over scan mode, PHY share and load shedding.
+ *
+ * @param[in] is_narrow True to stay on 1M PHY if enabled, sheds coded PHY load.
+ * @param[out] p_window Next window.
+ */
+static void scan_window_select (const bool is_narrow, app_ble_window_t * const p_window)
+{
+    app_scan_schedule_entry_t entry;
+    memset (p_window, 0, sizeof (app_ble_window_t));
+
+    if (app_scan_schedule_entry_get (&entry))
+    {
+        p_window->channels = entry.channels;
+        p_window->is_125kbps = (APP_SCAN_SCHEDULE_PHY_CODED == entry.phy);
+        p_window->is_scheduled = true;
+        p_window->schedule_ms = entry.window_ms;
+    }
+    else
+    {
+        p_window->channels = m_scan_params.scan_channels;
+
+        if (ch_share_is_active())
+        {
+            const uint8_t ch = ch_share_next();
+            p_window->channels.channel_37 = (0U == ch);
+            p_window->channels.channel_38 = (1U == ch);
+            p_window->channels.channel_39 = (2U == ch);
+        }
+
+        p_window->is_concurrent = scan_is_concurrent (&m_scan_params) && (!is_narrow);
+        // Coded PHY session listens on 1M primary PHY too.
+        p_window->is_125kbps = p_window->is_concurrent
+                               || next_modulation_is_125kbps (is_narrow);
+    }
+}
+
+/** @brief Check if window can run on the radio setup of the running scan. */
+static bool scan_window_is_running (const app_ble_window_t * const p_window)
+{
+    return m_is_scan_current
+           && (p_window->channels.channel_37 == m_scan_window.channels.channel_37)
+           && (p_window->channels.channel_38 == m_scan_window.channels.channel_38)
+           && (p_window->channels.channel_39 == m_scan_window.channels.channel_39)
+           && (p_window->is_125kbps == m_scan_window.is_125kbps)
+           && (p_window->is_concurrent == m_scan_window.is_concurrent)
+           && (p_window->is_scheduled == m_scan_window.is_scheduled);
+}
+
+#ifndef CEEDLING
+static
+#endif
+void app_ble_on_schedule_timer (void * const p_context);
+
+#ifndef CEEDLING
+static
+#endif
+void app_ble_on_window_timer (void * const p_context);
+
+/**
+ * @brief Start a single-shot scan timer, creating it on first use.
+ *
+ * @param[in,out] p_timer Timer, NULL until created.
+ * @param[in] handler Function to call on timeout.
+ * @param[in] ms Time to timeout.
+ */
+static rd_status_t scan_timer_start (ri_timer_id_t * const p_timer,
+                                     const ruuvi_timer_timeout_handler_t handler,
+                                     const uint32_t ms)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (NULL == *p_timer)
+    {
+        err_code |= ri_timer_create (p_timer, RI_TIMER_MODE_SINGLE_SHOT, handler);
+    }
+
+    if (RD_SUCCESS == err_code)
+    {
+        err_code |= ri_timer_start (*p_timer, ms, NULL);
+    }
+
+    return err_code;
+}
+
+/** @brief Stop window timer, if running. */
+static void window_timer_stop (void)
+{
+    if (m_is_window_timer_running)
+    {
+        (void) ri_timer_stop (m_window_timer);
+        m_is_window_timer_running = false;
+    }
+}
+
+/**
+ * @brief Start scan on initialised radio.
+ *
+ * rt_adv_scan_start registers the handler and scans with driver timing, which
+ * is then replaced by host timing if set. Timing changes apply here, on the
+ * next re-arm, without radio reinit.
+ */
+static rd_status_t scan_arm (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    window_timer_stop();
+    err_code |= rt_adv_scan_start (&on_scan_isr);
+
+    if ((RD_SUCCESS == err_code) && (0U < m_scan_params.scan_interval_ms))
+    {
+        err_code |= ri_adv_scan_stop();
+        err_code |= ri_adv_scan_start (m_scan_params.scan_interval_ms,
+                                       m_scan_params.scan_window_ms);
+    }
+
+    if ((RD_SUCCESS == err_code) && (0U < m_scan_params.scan_timeout_ms))
+    {
+        err_code |= scan_timer_start (&m_window_timer, &app_ble_on_window_timer,
+                                      m_scan_params.scan_timeout_ms);
+        m_is_window_timer_running = (RD_SUCCESS == err_code);
+    }
+
+    return err_code;
+}
+
+/**
+ * @brief Account a window whose scan has started.
+ *
+ * @param[in] p_window Started window.
+ * @param[in] is_narrow True if window was narrowed to 1M PHY by load shedding.
+ */
+static rd_status_t scan_window_started (const app_ble_window_t * const p_window,
+                                        const bool is_narrow)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    m_scan_window = *p_window;
+    m_is_scan_current = true;
+    m_scan_params.is_current_modulation_125kbps = p_window->is_125kbps;
+
+    if (p_window->is_scheduled)
+    {
+        if (!m_is_schedule_entry_running)
+        {
+            err_code |= scan_timer_start (&m_schedule_timer, &app_ble_on_schedule_timer,
+                                          p_window->schedule_ms);
+            m_is_schedule_entry_running = (RD_SUCCESS == err_code);
+            m_schedule_entry_ms = app_clock_ms_get();
+        }
+    }
+    else
+    {
+        ch_share_window_start (&p_window->channels);
+
+        if (!p_window->is_concurrent)
+        {
+            phy_share_window_start (is_narrow, p_window->is_125kbps);
+        }
+    }
+
+    return err_code;
+}
+
+/** @brief Stop timer of running schedule entry, entry starts over with next scan. */
+static void schedule_entry_stop (void)
+{
+    if (m_is_schedule_entry_running)
+    {
+        (void) ri_timer_stop (m_schedule_timer);
+        m_is_schedule_entry_running = false;
+    }
+}
+
+/**
+ * @brief Restart radio and scan in given window.
+ *
+ * @param[in] p_window Window to scan.
+ * @param[in] is_narrow True if window was narrowed to 1M PHY by load shedding.
+ */
+static rd_status_t scan_restart (const app_ble_window_t * const p_window,
+                                 const bool is_narrow)
 {
     NRF_LOG_INFO ("%s", __func__);
     rd_status_t err_code = RD_SUCCESS;
+    m_is_scan_current = false;
+    m_phy_share.window_rx = 0;
+    memset (m_ch_share.window_rx, 0, sizeof (m_ch_share.window_rx));
 
-    if (scan_is_enabled (&m_scan_params))
+    if (scan_is_enabled (&m_scan_params) || p_window->is_scheduled)
     {
         err_code |= rt_adv_uninit();
         err_code |= ri_radio_uninit();
         rt_adv_init_t adv_params =
         {
-            .channels = m_scan_params.scan_channels,
+            .channels = p_window->channels,
             .adv_interval_ms = (1000U), //!< Unused
             .adv_pwr_dbm     = (0),     //!< Unused
             .manufacturer_id = m_scan_params.manufacturer_id,
@@ -304,25 +1019,49 @@ rd_status_t app_ble_scan_start (void)
         adv_params.is_rx_le_coded_phy_enabled = m_scan_params.modulation_125kbps_enabled;
         adv_params.max_adv_length = m_scan_params.max_adv_length;
 
+        if (p_window->is_scheduled)
+        {
+            // Schedule entry picks the PHY regardless of enabled modulations.
+            adv_params.is_rx_le_1m_phy_enabled |= (!p_window->is_125kbps);
+            adv_params.is_rx_le_coded_phy_enabled |= p_window->is_125kbps;
+        }
+        else if (p_window->is_concurrent)
+        {
+            // Driver scans both primary PHYs only if both are requested.
+            adv_params.is_rx_le_1m_phy_enabled = true;
+            adv_params.is_rx_le_coded_phy_enabled = true;
+        }
+        else
+        {
+            // No action needed.
+        }
+
         if (RD_SUCCESS == err_code)
         {
             NRF_LOG_INFO ("PHYs enabled: LE 1M PHY=%d, LE 2M PHY=%d, LE Coded PHY=%d",
                           m_scan_params.modulation_1mbit_enabled,
                           m_scan_params.modulation_2mbit_enabled,
                           m_scan_params.modulation_125kbps_enabled);
-            next_modulation_select();
             NRF_LOG_INFO ("Current PHY: %s",
-                          m_scan_params.is_current_modulation_125kbps
-                          ? "LE Coded PHY"
-                          : "LE 1M PHY");
+                          p_window->is_concurrent
+                          ? "LE Coded PHY + LE 1M PHY"
+                          : (p_window->is_125kbps
+                             ? "LE Coded PHY"
+                             : "LE 1M PHY"));
             err_code |= pa_lna_ctrl();
-            err_code |= ri_radio_init (m_scan_params.is_current_modulation_125kbps ?
+            err_code |= ri_radio_init (p_window->is_125kbps ?
                                        RI_RADIO_BLE_125KBPS : RI_RADIO_BLE_1MBPS);
 
             if (RD_SUCCESS == err_code)
             {
+                app_stats_inc (APP_STATS_SCAN_RESTART);
                 err_code |= rt_adv_init (&adv_params);
-                err_code |= rt_adv_scan_start (&on_scan_isr);
+                err_code |= scan_arm();
+
+                if (RD_SUCCESS == err_code)
+                {
+                    err_code |= scan_window_started (p_window, is_narrow);
+                }
             }
         }
         else
@@ -338,9 +1077,106 @@ rd_status_t app_ble_scan_start (void)
     return err_code;
 }
 
+/**
+ * @brief Start next scan window after timeout.
+ *
+ * Radio is restarted only if next window differs from the running one, i.e.
+ * parameters have changed or the window is on another PHY or channels.
+ * Otherwise the same scan is re-armed, which keeps the gap between windows
+ * short. Both gaps are recorded in app_latency.
+ */
+static rd_status_t scan_window_next (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    const uint32_t start_cycles = app_clock_cycles_get();
+    app_ble_window_t window;
+
+    if (m_is_scan_current && (!m_scan_window.is_scheduled))
+    {
+        ch_share_window_end (&m_scan_window.channels);
+
+        if (!m_scan_window.is_concurrent)
+        {
+            phy_share_window_end (m_scan_window.is_125kbps);
+        }
+    }
+
+    const bool is_narrow = (APP_ADV_FILTER_SHED_NARROW <= app_adv_filter_shed_peak_take());
+    scan_window_select (is_narrow, &window);
+
+    if (scan_window_is_running (&window) && (RD_SUCCESS == scan_arm()))
+    {
+        err_code |= scan_window_started (&window, is_narrow);
+        app_stats_inc (APP_STATS_SCAN_REARM);
+        app_latency_record_cycles (APP_LATENCY_STAGE_SCAN_REARM,
+                                   app_clock_cycles_get() - start_cycles);
+    }
+    else
+    {
+        // Full restart also recovers from a failed re-arm.
+        err_code |= scan_restart (&window, is_narrow);
+        app_latency_record_cycles (APP_LATENCY_STAGE_SCAN_RESTART,
+                                   app_clock_cycles_get() - start_cycles);
+    }
+
+    return err_code;
+}
+
+/**
+ * @brief End schedule entry and move scan to the next one.
+ *
+ * Runs on timer, at the same interrupt priority as scan events.
+ */
+#ifndef CEEDLING
+static
+#endif
+void app_ble_on_schedule_timer (void * const p_context)
+{
+    (void) p_context;
+    rd_status_t err_code = RD_SUCCESS;
+    // Entries last longer than cycle counter wraps and it stops in sleep.
+    const uint32_t spent_ms = app_clock_ms_get() - m_schedule_entry_ms;
+    app_scan_schedule_advance (spent_ms);
+    m_is_schedule_entry_running = false;
+    // Scan may be between windows, re-arm falls back to restart if stop failed.
+    (void) rt_adv_scan_stop();
+    err_code |= scan_window_next();
+    RD_ERROR_CHECK (err_code, ~RD_ERROR_FATAL);
+}
+
+/**
+ * @brief End scan window at host timeout and move scan to the next one.
+ *
+ * Runs on timer, at the same interrupt priority as scan events.
+ */
+#ifndef CEEDLING
+static
+#endif
+void app_ble_on_window_timer (void * const p_context)
+{
+    (void) p_context;
+    rd_status_t err_code = RD_SUCCESS;
+    m_is_window_timer_running = false;
+    (void) rt_adv_scan_stop();
+    err_code |= scan_window_next();
+    RD_ERROR_CHECK (err_code, ~RD_ERROR_FATAL);
+}
+
+rd_status_t app_ble_scan_start (void)
+{
+    app_ble_window_t window;
+    const bool is_narrow = (APP_ADV_FILTER_SHED_NARROW <= app_adv_filter_shed_peak_take());
+    schedule_entry_stop();
+    scan_window_select (is_narrow, &window);
+    return scan_restart (&window, is_narrow);
+}
+
 rd_status_t app_ble_scan_stop (void)
 {
     rd_status_t err_code = RD_SUCCESS;
+    m_is_scan_current = false;
+    schedule_entry_stop();
+    window_timer_stop();
     err_code |= rt_adv_scan_stop();
     return err_code;
 }
@@ -15,6 +15,14 @@
 #include "ruuvi_interface_communication_radio.h"
 #include "ruuvi_interface_communication_ble_advertising.h"
 
+/** @brief How enabled primary PHYs share scan time. */
+typedef enum
+{
+    APP_BLE_SCAN_MODE_ALTERNATE = 0,  //!< Coded and 1M PHY in turns, radio restarted between.
+    APP_BLE_SCAN_MODE_CONCURRENT = 1, //!< Coded and 1M PHY in one session, if supported.
+    APP_BLE_SCAN_MODE_NUM             //!< Number of modes, not a valid mode.
+} app_ble_scan_mode_t;
+
 /** @brief definition of application scan parameters */
 typedef struct
 {
@@ -25,9 +33,21 @@ typedef struct
     bool modulation_2mbit_enabled;     //!< True to enable scanning for extended advs at 2 MBit/s.
     bool manufacturer_filter_enabled;  //!< True to scan only data of one manufacturer.
     bool is_current_modulation_125kbps; //!< Modulation used currently.
+    app_ble_scan_mode_t scan_mode;     //!< How enabled PHYs share scan time.
+    uint16_t scan_interval_ms;         //!< Scan interval, 0 for driver default.
+    uint16_t scan_window_ms;           //!< Listening time per interval, 0 for driver default.
+    uint16_t scan_timeout_ms;          //!< Longest scan window, 0 for driver timeout.
     uint8_t max_adv_length;            //!< Maximum length of advertisement data
 } app_ble_scan_t;
 
+/** @brief Time forwarded advertisements waited in pool. */
+typedef struct
+{
+    uint32_t count;   //!< Number of forwarded advertisements.
+    uint32_t mean_ms; //!< Mean age at forwarding.
+    uint32_t max_ms;  //!< Highest age at forwarding.
+} app_ble_adv_age_t;
+
 /**
  * @brief Enable or disable id filter.
  *
@@ -83,6 +103,82 @@ void app_ble_set_max_adv_len (uint8_t max_adv_length);
 rd_status_t app_ble_modulation_enable (const ri_radio_modulation_t modulation,
                                        const bool enable);
 
+/**
+ * @brief Select how enabled primary PHYs share scan time.
+ *
+ * In concurrent mode a session with both coded and 1M or 2M PHY enabled scans
+ * coded and 1M primary PHYs together, and scan windows are re-armed without
+ * radio restart. With only one of them enabled, or while load shedding narrows
+ * scan to 1M PHY, scanning works as in alternate mode.
+ * Takes effect on next @ref app_ble_scan_start.
+ *
+ * @param[in] mode Scan mode.
+ * @retval RD_SUCCESS on success.
+ * @retval RD_ERROR_INVALID_PARAM If mode is not valid.
+ * @retval RD_ERROR_NOT_SUPPORTED If mode is not supported by board.
+ * @retval RD_ERROR_INVALID_STATE If mode is concurrent and scan timing set by
+ *                                @ref app_ble_scan_timing_set has interval
+ *                                shorter than twice the window.
+ */
+rd_status_t app_ble_scan_mode_set (const app_ble_scan_mode_t mode);
+
+/**
+ * @brief Set bounds of coded PHY share of scan time.
+ *
+ * When coded and 1M or 2M PHY are both enabled in alternate mode, scan windows
+ * are split between the PHYs in proportion to advertisements accepted per
+ * window on each, within these bounds. Equal bounds give a fixed split, 50 and
+ * 50 strict alternation. Restarts traffic statistics.
+ *
+ * @param[in] min_percent Lowest share of windows on coded PHY.
+ * @param[in] max_percent Highest share of windows on coded PHY.
+ * @retval RD_SUCCESS on success.
+ * @retval RD_ERROR_INVALID_PARAM If min_percent > max_percent or max_percent > 100.
+ */
+rd_status_t app_ble_phy_share_set (const uint8_t min_percent, const uint8_t max_percent);
+
+/**
+ * @brief Set dwell time of primary advertising channels.
+ *
+ * In adaptive mode each scan window covers one enabled channel. Channels get
+ * windows in proportion to their weights: advertisements accepted per window
+ * on each, clamped to given bounds. A channel with heavy interference at a
+ * site yields less and is scanned less. Each change of channel restarts the
+ * radio. Otherwise every window covers all enabled channels. Restarts yield
+ * statistics.
+ *
+ * @param[in] is_adaptive True to weigh channels by yield.
+ * @param[in] min_percent Lowest weight of an enabled channel.
+ * @param[in] max_percent Highest weight of an enabled channel.
+ * @retval RD_SUCCESS on success.
+ * @retval RD_ERROR_INVALID_PARAM If min_percent is 0, min_percent > max_percent
+ *                                or max_percent > 100.
+ */
+rd_status_t app_ble_channel_dwell_set (const bool is_adaptive, const uint8_t min_percent,
+                                       const uint8_t max_percent);
+
+/**
+ * @brief Set scan timing.
+ *
+ * Radio listens for window_ms of every interval_ms and moves to the next scan
+ * window, possibly on another PHY, after timeout_ms. Applies from the next
+ * window without radio reinit. Timeout can only shorten windows of driver.
+ *
+ * @param[in] interval_ms Scan interval, 0 to use driver default timing.
+ * @param[in] window_ms Listening time per interval, 0 if interval_ms is 0.
+ * @param[in] timeout_ms Longest scan window, 0 to end windows on driver timeout only.
+ * @retval RD_SUCCESS on success.
+ * @retval RD_ERROR_INVALID_PARAM If only one of interval_ms and window_ms is 0,
+ *                                window_ms is not within
+ *                                APP_BLE_SCAN_INTERVAL_MIN_MS ... interval_ms,
+ *                                interval_ms exceeds APP_BLE_SCAN_INTERVAL_MAX_MS,
+ *                                interval_ms is shorter than twice window_ms in
+ *                                concurrent scan mode or timeout_ms is below
+ *                                APP_BLE_SCAN_TIMEOUT_MIN_MS.
+ */
+rd_status_t app_ble_scan_timing_set (const uint16_t interval_ms, const uint16_t window_ms,
+                                     const uint16_t timeout_ms);
+
 /**
  * @brief Start a scan sequence.
  *
@@ -91,6 +187,10 @@ rd_status_t app_ble_modulation_enable (const ri_radio_modulation_t modulation,
  * callback on data. If all PHYs are disabled, calls app_ble_scan_stop() to
  * stop scanning process until any PHY is reactivated.
  *
+ * If app_scan_schedule has entries, scan runs through them instead, each on its
+ * own PHY and channels for its window length. Schedule overrides scan mode, PHY
+ * share and load shedding, and scans even if all PHYs are disabled.
+ *
  * @retval RD_SUCCESS on success.
  *
  */
@@ -119,10 +219,42 @@ bool app_ble_manufacturer_filter_enabled (uint16_t * const p_manufacturer_id);
  */
 rd_status_t app_ble_scan_stop (void);
 
+/**
+ * @brief Forward scanned advertisements to UART.
+ *
+ * Takes at most APP_BLE_ADV_FORWARD_BUDGET advertisements stored by scan ISR
+ * out of app_adv_pool, so that main loop gets back to UART control events
+ * quickly. Advertisements stay in pool while UART TX queue is full. Call from
+ * main loop after the scheduler.
+ *
+ * Advertisements which have waited longer than the maximum age set with
+ * @ref app_ble_adv_max_age_set are dropped instead of forwarded.
+ *
+ * @return True if budget ran out before pool, call again before sleeping.
+ */
+bool app_ble_adv_forward (void);
+
+/**
+ * @brief Set maximum age of forwarded advertisements.
+ *
+ * Age is measured from reception in scan ISR at app_clock resolution.
+ *
+ * @param[in] max_age_ms Drop advertisements older than this, 0 to forward all.
+ */
+void app_ble_adv_max_age_set (const uint16_t max_age_ms);
+
+/**
+ * @brief Get age statistics of forwarded advertisements and restart them.
+ *
+ * @param[out] p_age Statistics since previous call.
+ */
+void app_ble_adv_age_take (app_ble_adv_age_t * const p_age);
+
 #ifdef CEEDLING
 rd_status_t on_scan_isr (const ri_comm_evt_t evt, void * p_data, // -V2009
                          size_t data_len);
-void repeat_adv (void * p_data, uint16_t data_len);
+void app_ble_on_schedule_timer (void * const p_context);
+void app_ble_on_window_timer (void * const p_context);
 #endif
 
 #endif
@@ -0,0 +1,188 @@
+/**
+ * @addtogroup APP_UART
+ * @{
+ */
+/**
+ *  @file app_ca_uart_ext.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Gateway-specific extensions to the CA UART protocol.
+ */
+#include "app_ca_uart_ext.h"
+#include <string.h>
+
+#define EXT_STX_INDEX     (0U) //!< Index of STX.
+#define EXT_LEN_INDEX     (1U) //!< Index of LEN.
+#define EXT_CMD_INDEX     (2U) //!< Index of CMD.
+#define EXT_PAYLOAD_INDEX (3U) //!< Index of first payload byte.
+#define EXT_CRC_INIT      (0xFFFFU) //!< CRC-16/CCITT-FALSE initial value.
+#define EXT_CRC_POLY      (0x1021U) //!< CRC-16/CCITT-FALSE polynomial.
+
+#define EXT_ADV_FLAG_CODED_PHY (1U << 0U) //!< Record was received on coded PHY.
+
+static uint16_t ext_crc16 (const uint8_t * const p_data, const size_t len)
+{
+    uint16_t crc = EXT_CRC_INIT;
+
+    for (size_t ii = 0; ii < len; ii++)
+    {
+        crc ^= (uint16_t) ((uint16_t) p_data[ii] << 8U);
+
+        for (uint8_t bit = 0; bit < 8U; bit++)
+        {
+            crc = (crc & 0x8000U) ? (uint16_t) ((crc << 1U) ^ EXT_CRC_POLY)
+                  : (uint16_t) (crc << 1U);
+        }
+    }
+
+    return crc;
+}
+
+static void ext_trailer_write (uint8_t * const p_buf, const uint8_t payload_len)
+{
+    const size_t crc_index = EXT_PAYLOAD_INDEX + payload_len;
+    p_buf[EXT_LEN_INDEX] = (uint8_t) (payload_len + CMD_IN_LEN);
+    const uint16_t crc = ext_crc16 (p_buf, crc_index);
+    p_buf[crc_index] = (uint8_t) (crc & 0xFFU);
+    p_buf[crc_index + 1U] = (uint8_t) (crc >> 8U);
+    p_buf[crc_index + 2U] = RE_CA_UART_ETX;
+}
+
+rd_status_t app_ca_uart_ext_decode (const uint8_t * const p_buf, const size_t buf_len,
+                                    app_ca_uart_ext_frame_t * const p_frame)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((NULL == p_buf) || (NULL == p_frame))
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if ((APP_CA_UART_EXT_OVERHEAD > buf_len)
+             || (RE_CA_UART_STX != p_buf[EXT_STX_INDEX])
+             || (CMD_IN_LEN > p_buf[EXT_LEN_INDEX])
+             || (APP_CA_UART_EXT_CMD_FIRST > p_buf[EXT_CMD_INDEX])
+             || (APP_CA_UART_EXT_CMD_LAST < p_buf[EXT_CMD_INDEX]))
+    {
+        err_code |= RD_ERROR_INVALID_DATA;
+    }
+    else
+    {
+        const uint8_t payload_len = (uint8_t) (p_buf[EXT_LEN_INDEX] - CMD_IN_LEN);
+        const size_t crc_index = EXT_PAYLOAD_INDEX + payload_len;
+
+        if (((crc_index + APP_CA_UART_EXT_TRAILER_LEN) > buf_len)
+                || (RE_CA_UART_ETX != p_buf[crc_index + 2U]))
+        {
+            err_code |= RD_ERROR_INVALID_DATA;
+        }
+        else
+        {
+            const uint16_t crc = (uint16_t) (p_buf[crc_index]
+                                             | ((uint16_t) p_buf[crc_index + 1U] << 8U));
+
+            if (ext_crc16 (p_buf, crc_index) != crc)
+            {
+                err_code |= RD_ERROR_INVALID_DATA;
+            }
+            else
+            {
+                p_frame->cmd = p_buf[EXT_CMD_INDEX];
+                p_frame->payload_len = payload_len;
+                p_frame->p_payload = &p_buf[EXT_PAYLOAD_INDEX];
+            }
+        }
+    }
+
+    return err_code;
+}
+
+rd_status_t app_ca_uart_ext_encode (uint8_t * const p_buf, uint8_t * const p_buf_len,
+                                    const uint8_t cmd, const uint8_t * const p_payload,
+                                    const uint8_t payload_len)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((NULL == p_buf) || (NULL == p_buf_len)
+            || ((NULL == p_payload) && (0U != payload_len)))
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if ((APP_CA_UART_EXT_PAYLOAD_MAX < payload_len)
+             || (((size_t) payload_len + APP_CA_UART_EXT_OVERHEAD) > *p_buf_len))
+    {
+        err_code |= RD_ERROR_DATA_SIZE;
+    }
+    else
+    {
+        p_buf[EXT_STX_INDEX] = RE_CA_UART_STX;
+        p_buf[EXT_CMD_INDEX] = cmd;
+
+        if (0U != payload_len)
+        {
+            memcpy (&p_buf[EXT_PAYLOAD_INDEX], p_payload, payload_len);
+        }
+
+        ext_trailer_write (p_buf, payload_len);
+        *p_buf_len = (uint8_t) (payload_len + APP_CA_UART_EXT_OVERHEAD);
+    }
+
+    return err_code;
+}
+
+void app_ca_uart_ext_batch_init (uint8_t * const p_buf, uint8_t * const p_buf_len)
+{
+    p_buf[EXT_STX_INDEX] = RE_CA_UART_STX;
+    p_buf[EXT_LEN_INDEX] = 0U;
+    p_buf[EXT_CMD_INDEX] = APP_CA_UART_EXT_ADV_BATCH;
+    p_buf[EXT_PAYLOAD_INDEX] = 0U; // Record count.
+    *p_buf_len = EXT_PAYLOAD_INDEX + 1U;
+}
+
+uint8_t app_ca_uart_ext_batch_count (const uint8_t * const p_buf)
+{
+    return p_buf[EXT_PAYLOAD_INDEX];
+}
+
+rd_status_t app_ca_uart_ext_batch_add (uint8_t * const p_buf, uint8_t * const p_buf_len,
+                                       const size_t buf_max,
+                                       const re_ca_uart_ble_adv_t * const p_adv)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    const size_t record_len = APP_CA_UART_EXT_ADV_RECORD_HEADER_LEN + p_adv->adv_len;
+    const size_t payload_len = (size_t) (*p_buf_len - EXT_PAYLOAD_INDEX) + record_len;
+
+    if ((APP_CA_UART_EXT_PAYLOAD_MAX < payload_len)
+            || ((EXT_PAYLOAD_INDEX + payload_len + APP_CA_UART_EXT_TRAILER_LEN) > buf_max)
+            || (UINT8_MAX == p_buf[EXT_PAYLOAD_INDEX]))
+    {
+        err_code |= RD_ERROR_NO_MEM;
+    }
+    else
+    {
+        uint8_t * p_rec = &p_buf[*p_buf_len];
+        memcpy (p_rec, p_adv->mac, sizeof (p_adv->mac));
+        p_rec += sizeof (p_adv->mac);
+        *p_rec++ = (uint8_t) p_adv->rssi_db;
+        *p_rec++ = (uint8_t) p_adv->primary_phy;
+        *p_rec++ = (uint8_t) p_adv->secondary_phy;
+        *p_rec++ = p_adv->ch_index;
+        *p_rec++ = p_adv->is_coded_phy ? EXT_ADV_FLAG_CODED_PHY : 0U;
+        *p_rec++ = (uint8_t) p_adv->tx_power;
+        *p_rec++ = p_adv->adv_len;
+        memcpy (p_rec, p_adv->adv, p_adv->adv_len);
+        *p_buf_len = (uint8_t) (*p_buf_len + record_len);
+        p_buf[EXT_PAYLOAD_INDEX]++;
+    }
+
+    return err_code;
+}
+
+void app_ca_uart_ext_batch_close (uint8_t * const p_buf, uint8_t * const p_buf_len)
+{
+    const uint8_t payload_len = (uint8_t) (*p_buf_len - EXT_PAYLOAD_INDEX);
+    ext_trailer_write (p_buf, payload_len);
+    *p_buf_len = (uint8_t) (*p_buf_len + APP_CA_UART_EXT_TRAILER_LEN);
+}
+
+/** @} */
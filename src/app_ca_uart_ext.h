@@ -0,0 +1,215 @@
+#ifndef APP_CA_UART_EXT_H
+#define APP_CA_UART_EXT_H
+
+/**
+ * @addtogroup APP_UART
+ * @{
+ */
+/**
+ *  @file app_ca_uart_ext.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Gateway-specific extensions to the CA UART protocol.
+ *
+ *  Extension frames share the CA UART envelope
+ *  STX | LEN | CMD | payload | CRC16 | ETX, where LEN counts CMD and payload
+ *  and CRC16 is CRC-16/CCITT-FALSE over STX..payload sent LSB first.
+ *  Payload is raw binary without field delimiters. Command codes are
+ *  allocated from a range not used by ruuvi.endpoints.c so that a host
+ *  can probe support: firmware without extensions never ACKs them.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "ruuvi_driver_error.h"
+#include "ruuvi_endpoint_ca_uart.h"
+
+#define APP_CA_UART_EXT_HEADER_LEN   (3U) //!< STX, LEN, CMD.
+#define APP_CA_UART_EXT_TRAILER_LEN  (3U) //!< CRC16, ETX.
+#define APP_CA_UART_EXT_OVERHEAD \
+    (APP_CA_UART_EXT_HEADER_LEN + APP_CA_UART_EXT_TRAILER_LEN) //!< Frame envelope.
+#define APP_CA_UART_EXT_PAYLOAD_MAX  (UINT8_MAX - CMD_IN_LEN) //!< LEN is one byte.
+
+/** @brief Size of one advertisement record in a batch frame, excluding data. */
+#define APP_CA_UART_EXT_ADV_RECORD_HEADER_LEN (13U)
+
+/**
+ * @brief Extension command codes.
+ */
+typedef enum
+{
+    APP_CA_UART_EXT_CMD_FIRST = 0x60,       //!< First code reserved for extensions.
+    APP_CA_UART_EXT_ACK = 0x60,             //!< [cmd, status] response to an extension command.
+    APP_CA_UART_EXT_SET_REPORT_MODE = 0x61, //!< [mode, max_batch] select report framing.
+    APP_CA_UART_EXT_ADV_BATCH = 0x62,       //!< [count, records...] batched adv reports.
+    APP_CA_UART_EXT_SET_DEDUP_WINDOW = 0x63, //!< [window_ms LSB, MSB] duplicate suppression.
+    APP_CA_UART_EXT_SET_RATE_LIMIT = 0x64,   //!< [interval_ms LSB, MSB] per-tag rate limit.
+    APP_CA_UART_EXT_SET_RSSI_FLOOR = 0x65,   //!< [floor_dbm, hysteresis_db] RSSI filter.
+    APP_CA_UART_EXT_MAC_LIST_CLEAR = 0x66,   //!< [] start uploading a new MAC list.
+    APP_CA_UART_EXT_MAC_LIST_ADD = 0x67,     //!< [mac0[6], mac1[6]...] add MACs to upload.
+    APP_CA_UART_EXT_MAC_LIST_MODE = 0x68,    //!< [mode] activate list, app_mac_list_mode_t.
+    APP_CA_UART_EXT_SET_MANUFACTURER_IDS = 0x69, //!< [flags, id0 LSB, MSB...] extra IDs.
+    APP_CA_UART_EXT_SET_MATCH_PROGRAM = 0x6A,    //!< [instructions...] app_adv_match.
+    APP_CA_UART_EXT_GET_DROPS = 0x6B,            //!< [] query drop counters.
+    APP_CA_UART_EXT_DROPS = 0x6C,                //!< [shed, count, u32 LSB first...] reply.
+    APP_CA_UART_EXT_SET_MAX_AGE = 0x6D,          //!< [max_age_ms LSB, MSB] drop older advs.
+    APP_CA_UART_EXT_GET_QUEUE_AGE = 0x6E,        //!< [] query and restart queue age.
+    APP_CA_UART_EXT_QUEUE_AGE = 0x6F,            //!< [count, mean_ms, max_ms] u32 reply.
+    APP_CA_UART_EXT_GET_LATENCY = 0x70,          //!< [stage] query and restart histogram.
+    APP_CA_UART_EXT_LATENCY = 0x71,              //!< [stage, buckets, u16 counts...] reply.
+    APP_CA_UART_EXT_GET_STATS = 0x72,            //!< [] query forwarding counters.
+    APP_CA_UART_EXT_STATS = 0x73,                //!< [count, u32 LSB first...] reply.
+    APP_CA_UART_EXT_RESET_STATS = 0x74,          //!< [] clear forwarding and drop counters.
+    APP_CA_UART_EXT_SET_SCAN_MODE = 0x75,        //!< [mode] app_ble_scan_mode_t, restarts scan.
+    APP_CA_UART_EXT_SET_PHY_SHARE = 0x76,        //!< [min_pct, max_pct] coded PHY scan share.
+    APP_CA_UART_EXT_SET_SCAN_SCHEDULE = 0x77,    //!< [entries...] app_scan_schedule.
+    APP_CA_UART_EXT_GET_SCAN_SCHEDULE_TIME = 0x78, //!< [] query and restart entry times.
+    APP_CA_UART_EXT_SCAN_SCHEDULE_TIME = 0x79,   //!< [count, u32 ms LSB first...] reply.
+    APP_CA_UART_EXT_SET_SCAN_TIMING = 0x7A,      //!< [interval, window, timeout] u16 ms.
+    APP_CA_UART_EXT_SET_CHANNEL_DWELL = 0x7B,    //!< [adaptive, min_pct, max_pct] per channel.
+    APP_CA_UART_EXT_CMD_LAST = 0x7F         //!< Last code reserved for extensions.
+} app_ca_uart_ext_cmd_t;
+
+#define APP_CA_UART_EXT_MANUFACTURER_ACCEPT_NONE (1U << 0U) //!< Accept advs without ID.
+
+/**
+ * @brief Maximum number of MACs in one APP_CA_UART_EXT_MAC_LIST_ADD frame.
+ *
+ * Frame has to fit UART receive buffer, host splits longer lists into chunks.
+ */
+#define APP_CA_UART_EXT_MAC_LIST_ADD_MAX (16U)
+
+/**
+ * @brief Offset of first counter in APP_CA_UART_EXT_DROPS payload.
+ *
+ * Payload is current load shedding level, number of counters and the drop
+ * counters by reason starting from APP_ADV_FILTER_REJECT_INVALID. Host should
+ * rely on the count, new reasons may be appended.
+ */
+#define APP_CA_UART_EXT_DROPS_COUNTERS_POS (2U)
+
+/**
+ * @brief Length of APP_CA_UART_EXT_GET_LATENCY payload.
+ *
+ * Payload is one app_latency_stage_t, all stages do not fit one reply.
+ * Query of unknown stage is NACKed, host queries stages until NACK.
+ */
+#define APP_CA_UART_EXT_GET_LATENCY_LEN (1U)
+
+/**
+ * @brief Offset of first count in APP_CA_UART_EXT_LATENCY payload.
+ *
+ * Payload is the queried stage, number of buckets and the bucket counts
+ * of the stage as uint16 LSB first.
+ */
+#define APP_CA_UART_EXT_LATENCY_COUNTS_POS (2U)
+
+/**
+ * @brief Offset of first counter in APP_CA_UART_EXT_STATS payload.
+ *
+ * Payload is number of counters and the counters in app_stats_counter_t
+ * order. Drops by reason are in APP_CA_UART_EXT_DROPS.
+ */
+#define APP_CA_UART_EXT_STATS_COUNTERS_POS (1U)
+
+/**
+ * @brief Offset of first time in APP_CA_UART_EXT_SCAN_SCHEDULE_TIME payload.
+ *
+ * Payload is number of schedule entries and milliseconds spent on each entry
+ * since previous query, in schedule order.
+ */
+#define APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS (1U)
+
+/**
+ * @brief Advertisement report framing negotiated with host.
+ */
+typedef enum
+{
+    APP_CA_UART_EXT_REPORT_SINGLE = 0, //!< One RE_CA_UART_ADV_RPRT2 frame per adv, default.
+    APP_CA_UART_EXT_REPORT_BATCH = 1,  //!< Pack pending advs into APP_CA_UART_EXT_ADV_BATCH.
+} app_ca_uart_ext_report_mode_t;
+
+/**
+ * @brief Decoded extension frame. Payload points into the decoded buffer.
+ */
+typedef struct
+{
+    uint8_t cmd;               //!< One of @ref app_ca_uart_ext_cmd_t.
+    uint8_t payload_len;       //!< Number of payload bytes.
+    const uint8_t * p_payload; //!< Payload, valid as long as source buffer is.
+} app_ca_uart_ext_frame_t;
+
+/**
+ * @brief Decode an extension frame.
+ *
+ * @param[in] p_buf Received bytes, starting with STX.
+ * @param[in] buf_len Number of received bytes.
+ * @param[out] p_frame Decoded frame.
+ * @retval RD_SUCCESS If buffer holds a valid extension frame.
+ * @retval RD_ERROR_NULL If any pointer was NULL.
+ * @retval RD_ERROR_INVALID_DATA If buffer is not an extension frame or CRC fails.
+ */
+rd_status_t app_ca_uart_ext_decode (const uint8_t * const p_buf, const size_t buf_len,
+                                    app_ca_uart_ext_frame_t * const p_frame);
+
+/**
+ * @brief Encode an extension frame.
+ *
+ * @param[out] p_buf Output buffer.
+ * @param[in,out] p_buf_len Size of output buffer in, encoded length out.
+ * @param[in] cmd Command to encode.
+ * @param[in] p_payload Payload to encode, may be NULL if payload_len is 0.
+ * @param[in] payload_len Length of payload.
+ * @retval RD_SUCCESS On success.
+ * @retval RD_ERROR_NULL If any required pointer was NULL.
+ * @retval RD_ERROR_DATA_SIZE If frame does not fit into buffer.
+ */
+rd_status_t app_ca_uart_ext_encode (uint8_t * const p_buf, uint8_t * const p_buf_len,
+                                    const uint8_t cmd, const uint8_t * const p_payload,
+                                    const uint8_t payload_len);
+
+/**
+ * @brief Start a batch frame with zero records.
+ *
+ * The frame is left open, its length and CRC are written by
+ * @ref app_ca_uart_ext_batch_close.
+ *
+ * @param[out] p_buf Frame buffer.
+ * @param[out] p_buf_len Length of frame so far.
+ */
+void app_ca_uart_ext_batch_init (uint8_t * const p_buf, uint8_t * const p_buf_len);
+
+/**
+ * @brief Append one advertisement to an open batch frame.
+ *
+ * @param[in,out] p_buf Open frame buffer.
+ * @param[in,out] p_buf_len Length of frame so far.
+ * @param[in] buf_max Size of frame buffer.
+ * @param[in] p_adv Advertisement to append.
+ * @retval RD_SUCCESS If record was appended.
+ * @retval RD_ERROR_NO_MEM If record does not fit, frame is unchanged.
+ */
+rd_status_t app_ca_uart_ext_batch_add (uint8_t * const p_buf, uint8_t * const p_buf_len,
+                                       const size_t buf_max,
+                                       const re_ca_uart_ble_adv_t * const p_adv);
+
+/**
+ * @brief Get number of records in an open batch frame.
+ */
+uint8_t app_ca_uart_ext_batch_count (const uint8_t * const p_buf);
+
+/**
+ * @brief Write length, CRC and ETX of an open batch frame.
+ *
+ * Caller must reserve @ref APP_CA_UART_EXT_TRAILER_LEN bytes after the last record,
+ * @ref app_ca_uart_ext_batch_add does so.
+ *
+ * @param[in,out] p_buf Open frame buffer.
+ * @param[in,out] p_buf_len Length of frame so far, total frame length out.
+ */
+void app_ca_uart_ext_batch_close (uint8_t * const p_buf, uint8_t * const p_buf_len);
+
+/** @} */
+#endif
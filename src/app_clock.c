@@ -0,0 +1,90 @@
+/**
+ *  @file app_clock.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Coarse millisecond clock for time-based filtering.
+ */
+
+#include "app_config.h"
+#include "app_clock.h"
+#include "ruuvi_interface_timer.h"
+#ifndef CEEDLING
+#include "nrf.h"
+#include "app_timer.h"
+
+_Static_assert ((APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1))
+                == APP_CLOCK_RTC_TICKS_PER_S, "APP_CLOCK_RTC_TICKS_PER_S must match app_timer");
+_Static_assert (APP_TIMER_MAX_CNT_VAL == APP_CLOCK_TICKS_MASK,
+                "APP_CLOCK_TICKS_MASK must match app_timer");
+#endif
+
+static ri_timer_id_t m_clock_timer;
+static volatile uint32_t m_clock_ms;
+
+#ifdef CEEDLING
+static uint32_t m_clock_cycles;
+static uint32_t m_clock_ticks;
+
+void app_clock_test_cycles_set (const uint32_t cycles)
+{
+    m_clock_cycles = cycles;
+}
+
+void app_clock_test_ticks_set (const uint32_t ticks)
+{
+    m_clock_ticks = ticks;
+}
+#endif
+
+#ifndef CEEDLING
+static
+#endif
+void app_clock_on_tick (void * const p_context)
+{
+    (void) p_context;
+    m_clock_ms += APP_CLOCK_TICK_MS;
+}
+
+rd_status_t app_clock_init (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    m_clock_ms = 0;
+#ifndef CEEDLING
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    err_code |= ri_timer_create (&m_clock_timer, RI_TIMER_MODE_REPEATED,
+                                 &app_clock_on_tick);
+
+    if (RD_SUCCESS == err_code)
+    {
+        err_code |= ri_timer_start (m_clock_timer, APP_CLOCK_TICK_MS, NULL);
+    }
+
+    return err_code;
+}
+
+uint32_t app_clock_ms_get (void)
+{
+    return m_clock_ms;
+}
+
+uint32_t app_clock_cycles_get (void)
+{
+#ifndef CEEDLING
+    return DWT->CYCCNT;
+#else
+    return m_clock_cycles;
+#endif
+}
+
+uint32_t app_clock_ticks_get (void)
+{
+#ifndef CEEDLING
+    return app_timer_cnt_get();
+#else
+    return m_clock_ticks;
+#endif
+}
@@ -0,0 +1,75 @@
+#ifndef APP_CLOCK_H
+#define APP_CLOCK_H
+
+/**
+ *  @file app_clock.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Coarse millisecond clock for time-based filtering.
+ *
+ *  nRF52811 has no spare RTC for ri_rtc, so the clock is advanced by a
+ *  repeated ri_timer at APP_CLOCK_TICK_MS resolution. Clock wraps around
+ *  after about 49 days, compare times by unsigned subtraction.
+ *
+ *  Short intervals are measured with the CPU cycle counter instead, which
+ *  wraps after 2^32 / (APP_CLOCK_CYCLES_PER_US * 1e6) seconds, 67 s at 64 MHz.
+ *  Cycle counter stops while CPU sleeps, use it only for intervals during
+ *  which CPU stays busy.
+ *
+ *  Intervals which span sleep are measured with the RTC counter of app_timer,
+ *  which ticks APP_CLOCK_RTC_TICKS_PER_S times per second also in sleep and
+ *  wraps at 24 bits, after 512 s at 32768 Hz.
+ */
+
+#include <stdint.h>
+#include "ruuvi_driver_error.h"
+
+#define APP_CLOCK_TICKS_MASK (0xFFFFFFUL) //!< RTC counter is 24 bits wide.
+
+/**
+ * @brief Time of an event which may be compared after CPU has slept.
+ */
+typedef struct
+{
+    uint32_t ms;    //!< Milliseconds, see @ref app_clock_ms_get.
+    uint32_t ticks; //!< RTC ticks, see @ref app_clock_ticks_get.
+} app_clock_stamp_t;
+
+/**
+ * @brief Start the clock. Requires ri_timer to be initialized.
+ *
+ * @retval RD_SUCCESS On success.
+ * @return Error code from timer driver on failure.
+ */
+rd_status_t app_clock_init (void);
+
+/**
+ * @brief Get milliseconds since @ref app_clock_init.
+ *
+ * Safe to call from interrupt context.
+ */
+uint32_t app_clock_ms_get (void);
+
+/**
+ * @brief Get CPU cycles since @ref app_clock_init.
+ *
+ * Safe to call from interrupt context.
+ */
+uint32_t app_clock_cycles_get (void);
+
+/**
+ * @brief Get RTC ticks of app_timer.
+ *
+ * Mask difference of two readings with APP_CLOCK_TICKS_MASK.
+ * Safe to call from interrupt context.
+ */
+uint32_t app_clock_ticks_get (void);
+
+#ifdef CEEDLING
+void app_clock_on_tick (void * const p_context);
+void app_clock_test_cycles_set (const uint32_t cycles);
+void app_clock_test_ticks_set (const uint32_t ticks);
+#endif
+
+#endif
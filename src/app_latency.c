@@ -0,0 +1,65 @@
+/**
+ *  @file app_latency.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Histograms of advertisement forwarding latency and of scan restart gaps.
+ */
+
+#include "app_latency.h"
+#include "app_clock.h"
+#include <string.h>
+
+_Static_assert ((APP_LATENCY_BUCKETS > 0U) && (APP_LATENCY_BUCKETS <= 32U),
+                "APP_LATENCY_BUCKETS must be 1 ... 32");
+
+static uint16_t m_counts[APP_LATENCY_STAGE_NUM][APP_LATENCY_BUCKETS];
+
+void app_latency_init (void)
+{
+    memset (m_counts, 0, sizeof (m_counts));
+}
+
+static void app_latency_record_us (const app_latency_stage_t stage, uint32_t us)
+{
+    if (APP_LATENCY_STAGE_NUM > stage)
+    {
+        uint8_t bucket = 0;
+
+        while ((1U < us) && ((APP_LATENCY_BUCKETS - 1U) > bucket))
+        {
+            us >>= 1U;
+            bucket++;
+        }
+
+        if (UINT16_MAX > m_counts[stage][bucket])
+        {
+            m_counts[stage][bucket]++;
+        }
+    }
+}
+
+void app_latency_record_cycles (const app_latency_stage_t stage, const uint32_t cycles)
+{
+    app_latency_record_us (stage, cycles / APP_CLOCK_CYCLES_PER_US);
+}
+
+void app_latency_record_ticks (const app_latency_stage_t stage, const uint32_t ticks)
+{
+    // Counter wraps at 24 bits, masked difference is the elapsed time.
+    const uint64_t us = ((uint64_t) (ticks & APP_CLOCK_TICKS_MASK) * 1000000U)
+                        / APP_CLOCK_RTC_TICKS_PER_S;
+    app_latency_record_us (stage, (uint32_t) us);
+}
+
+uint16_t app_latency_take (const app_latency_stage_t stage, const uint8_t bucket)
+{
+    uint16_t count = 0;
+
+    if ((APP_LATENCY_STAGE_NUM > stage) && (APP_LATENCY_BUCKETS > bucket))
+    {
+        count = __atomic_exchange_n (&m_counts[stage][bucket], 0U, __ATOMIC_RELAXED);
+    }
+
+    return count;
+}
@@ -0,0 +1,69 @@
+#ifndef APP_LATENCY_H
+#define APP_LATENCY_H
+
+/**
+ *  @file app_latency.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Histograms of advertisement forwarding latency and of scan restart gaps.
+ *
+ *  Latency is counted in APP_LATENCY_BUCKETS log2 buckets per stage: bucket n
+ *  counts latencies of 2^n to 2^(n+1) microseconds, first bucket includes 0
+ *  and last bucket everything longer. Counts saturate at UINT16_MAX.
+ *
+ *  Forwarding stages span main loop sleep, during which the CPU cycle counter
+ *  stops, so they are recorded in app_clock RTC ticks of about 30 us. Scan
+ *  restart gaps keep CPU busy and are recorded in CPU cycles.
+ *
+ *  Each stage must be recorded from one context only, a stage may be taken
+ *  from main context while it is recorded in interrupt.
+ */
+
+#include <stdint.h>
+#include "app_config.h"
+
+/**
+ * @brief Forwarding stages measured.
+ */
+typedef enum
+{
+    APP_LATENCY_STAGE_POOL = 0, //!< From scan ISR to taking advertisement from pool.
+    APP_LATENCY_STAGE_UART,     //!< From taking advertisement to UART TX complete.
+    APP_LATENCY_STAGE_TOTAL,    //!< From scan ISR to UART TX complete.
+    APP_LATENCY_STAGE_SCAN_REARM,   //!< From scan window timeout to same scan re-armed.
+    APP_LATENCY_STAGE_SCAN_RESTART, //!< From scan window timeout to radio restarted.
+    APP_LATENCY_STAGE_NUM       //!< Number of stages.
+} app_latency_stage_t;
+
+/**
+ * @brief Clear all histograms.
+ */
+void app_latency_init (void);
+
+/**
+ * @brief Count a latency measured in CPU cycles in histogram of a stage.
+ *
+ * @param[in] stage Stage measured, ignored if out of range.
+ * @param[in] cycles Latency in CPU cycles, CPU must not have slept meanwhile.
+ */
+void app_latency_record_cycles (const app_latency_stage_t stage, const uint32_t cycles);
+
+/**
+ * @brief Count a latency measured in app_clock RTC ticks in histogram of a stage.
+ *
+ * @param[in] stage Stage measured, ignored if out of range.
+ * @param[in] ticks Difference of two @ref app_clock_ticks_get readings, masked here.
+ */
+void app_latency_record_ticks (const app_latency_stage_t stage, const uint32_t ticks);
+
+/**
+ * @brief Get a histogram bucket and clear it.
+ *
+ * @param[in] stage Stage of histogram.
+ * @param[in] bucket Index of bucket, 0 ... APP_LATENCY_BUCKETS - 1.
+ * @return Count of bucket since previous take, 0 if stage or bucket is out of range.
+ */
+uint16_t app_latency_take (const app_latency_stage_t stage, const uint8_t bucket);
+
+#endif
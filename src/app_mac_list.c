@@ -0,0 +1,185 @@
+/**
+ *  @file app_mac_list.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  List of tag MAC addresses to forward or to drop.
+ */
+
+#include "app_mac_list.h"
+#include <string.h>
+
+#define APP_MAC_LIST_FNV_OFFSET (2166136261UL) //!< FNV-1a 32-bit offset basis.
+#define APP_MAC_LIST_FNV_PRIME  (16777619UL)   //!< FNV-1a 32-bit prime.
+#define APP_MAC_LIST_COUNT_MASK (0xFFFFUL)     //!< Address count bits of state.
+#define APP_MAC_LIST_MODE_POS   (16U)          //!< Mode position in state.
+#define APP_MAC_LIST_MODE_MASK  (0xFFUL)       //!< Mode bits of state after shift.
+#define APP_MAC_LIST_SET_POS    (24U)          //!< Active buffer bit of state.
+
+_Static_assert (APP_MAC_LIST_LEN <= UINT16_MAX, "APP_MAC_LIST_LEN must fit uint16_t");
+
+static uint32_t m_hashes[2][APP_MAC_LIST_LEN]; //!< Sorted ascending.
+/** @brief Active buffer, mode and address count packed into one word. */
+static volatile uint32_t m_state;
+static uint16_t m_upload_count;
+static bool m_is_uploading;
+
+static uint8_t app_mac_list_set (const uint32_t state)
+{
+    return (uint8_t) (state >> APP_MAC_LIST_SET_POS);
+}
+
+static uint8_t app_mac_list_mode (const uint32_t state)
+{
+    return (uint8_t) ((state >> APP_MAC_LIST_MODE_POS) & APP_MAC_LIST_MODE_MASK);
+}
+
+static uint16_t app_mac_list_state_count (const uint32_t state)
+{
+    return (uint16_t) (state & APP_MAC_LIST_COUNT_MASK);
+}
+
+static uint32_t app_mac_list_hash (const uint8_t * const p_mac)
+{
+    uint32_t hash = APP_MAC_LIST_FNV_OFFSET;
+
+    for (size_t ii = 0; ii < APP_MAC_LIST_MAC_LEN; ii++)
+    {
+        hash ^= p_mac[ii];
+        hash *= APP_MAC_LIST_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Find position of hash in list.
+ *
+ * @return Index of hash if listed, index where it would be inserted otherwise.
+ */
+static uint16_t app_mac_list_lower_bound (const uint32_t * const p_hashes,
+        const uint32_t hash, const uint16_t count)
+{
+    uint16_t low = 0;
+    uint16_t high = count;
+
+    while (low < high)
+    {
+        const uint16_t mid = (uint16_t) (low + ((high - low) / 2U));
+
+        if (p_hashes[mid] < hash)
+        {
+            low = (uint16_t) (mid + 1U);
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+void app_mac_list_clear (void)
+{
+    m_upload_count = 0;
+    m_is_uploading = true;
+}
+
+rd_status_t app_mac_list_add (const uint8_t * const p_macs, const size_t count)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (NULL == p_macs)
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if (!m_is_uploading)
+    {
+        err_code |= RD_ERROR_INVALID_STATE;
+    }
+    else
+    {
+        // Upload goes into the buffer ISR is not reading.
+        uint32_t * const p_hashes = m_hashes[app_mac_list_set (m_state) ^ 1U];
+        uint16_t list_len = m_upload_count;
+
+        for (size_t ii = 0; (ii < count) && (RD_SUCCESS == err_code); ii++)
+        {
+            const uint32_t hash = app_mac_list_hash (&p_macs[ii * APP_MAC_LIST_MAC_LEN]);
+            const uint16_t pos = app_mac_list_lower_bound (p_hashes, hash, list_len);
+
+            if ((pos < list_len) && (hash == p_hashes[pos]))
+            {
+                // Already listed.
+            }
+            else if (APP_MAC_LIST_LEN <= list_len)
+            {
+                err_code |= RD_ERROR_NO_MEM;
+            }
+            else
+            {
+                memmove (&p_hashes[pos + 1U], &p_hashes[pos],
+                         (size_t) (list_len - pos) * sizeof (p_hashes[0]));
+                p_hashes[pos] = hash;
+                list_len++;
+            }
+        }
+
+        m_upload_count = list_len;
+    }
+
+    return err_code;
+}
+
+rd_status_t app_mac_list_mode_set (const app_mac_list_mode_t mode)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if (APP_MAC_LIST_MODE_NUM <= mode)
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        const uint32_t state = m_state;
+        uint32_t set = app_mac_list_set (state);
+        uint32_t count = app_mac_list_state_count (state);
+
+        if (m_is_uploading)
+        {
+            set ^= 1U;
+            count = m_upload_count;
+            m_is_uploading = false;
+        }
+
+        m_state = (set << APP_MAC_LIST_SET_POS)
+                  | ((uint32_t) mode << APP_MAC_LIST_MODE_POS) | count;
+    }
+
+    return err_code;
+}
+
+bool app_mac_list_is_passed (const uint8_t * const p_mac)
+{
+    const uint32_t state = m_state;
+    const uint8_t mode = app_mac_list_mode (state);
+    bool is_passed = true;
+
+    if (APP_MAC_LIST_MODE_OFF != mode)
+    {
+        const uint32_t * const p_hashes = m_hashes[app_mac_list_set (state)];
+        const uint16_t count = app_mac_list_state_count (state);
+        const uint32_t hash = app_mac_list_hash (p_mac);
+        const uint16_t pos = app_mac_list_lower_bound (p_hashes, hash, count);
+        const bool is_listed = (pos < count) && (hash == p_hashes[pos]);
+        is_passed = (APP_MAC_LIST_MODE_ALLOW == mode) ? is_listed : !is_listed;
+    }
+
+    return is_passed;
+}
+
+uint16_t app_mac_list_count (void)
+{
+    return app_mac_list_state_count (m_state);
+}
@@ -0,0 +1,91 @@
+#ifndef APP_MAC_LIST_H
+#define APP_MAC_LIST_H
+
+/**
+ *  @file app_mac_list.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  List of tag MAC addresses to forward (allow mode) or to drop (deny mode).
+ *
+ *  List is stored as a sorted array of 32-bit hashes of the addresses,
+ *  4 bytes per tag instead of 6, and looked up with binary search in scan ISR.
+ *  A foreign tag passes the list only if its hash collides with a listed one,
+ *  which is unlikely at APP_MAC_LIST_LEN entries.
+ *
+ *  Host uploads the list in chunks: @ref app_mac_list_clear starts a new list,
+ *  @ref app_mac_list_add appends addresses and @ref app_mac_list_mode_set
+ *  activates it. New list is built in a second buffer while ISR keeps applying
+ *  the previous one, so upload needs no locking and the filter never opens up
+ *  in the middle of an upload. Upload must come from a single context.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app_config.h"
+#include "ruuvi_driver_error.h"
+
+#define APP_MAC_LIST_MAC_LEN (6U) //!< Bytes in BLE MAC address.
+
+/**
+ * @brief How listed tags are treated.
+ */
+typedef enum
+{
+    APP_MAC_LIST_MODE_OFF = 0, //!< List is not applied, default.
+    APP_MAC_LIST_MODE_ALLOW,   //!< Only listed tags are forwarded.
+    APP_MAC_LIST_MODE_DENY,    //!< Listed tags are dropped.
+    APP_MAC_LIST_MODE_NUM      //!< Number of modes, not a valid mode.
+} app_mac_list_mode_t;
+
+/**
+ * @brief Start uploading a new, empty list.
+ *
+ * Active list and mode are applied until @ref app_mac_list_mode_set.
+ */
+void app_mac_list_clear (void);
+
+/**
+ * @brief Add addresses to list being uploaded.
+ *
+ * Addresses already in list are ignored.
+ *
+ * @param[in] p_macs Addresses, APP_MAC_LIST_MAC_LEN bytes each in the byte
+ *                   order of advertisement reports.
+ * @param[in] count Number of addresses.
+ * @retval RD_SUCCESS If all addresses were added.
+ * @retval RD_ERROR_NULL If p_macs was NULL.
+ * @retval RD_ERROR_INVALID_STATE If no upload was started, clear list first.
+ * @retval RD_ERROR_NO_MEM If list is full, addresses before the first one not
+ *                         fitting were added.
+ */
+rd_status_t app_mac_list_add (const uint8_t * const p_macs, const size_t count);
+
+/**
+ * @brief Set mode of list, activating the uploaded list if any.
+ *
+ * Without an upload in progress only the mode of active list is changed.
+ *
+ * @param[in] mode Mode to apply.
+ * @retval RD_SUCCESS On success.
+ * @retval RD_ERROR_INVALID_PARAM If mode is not valid, upload stays in progress.
+ */
+rd_status_t app_mac_list_mode_set (const app_mac_list_mode_t mode);
+
+/**
+ * @brief Check if a tag passes the list.
+ *
+ * Safe to call from interrupt context.
+ *
+ * @param[in] p_mac Address of tag.
+ * @return True if tag should be forwarded.
+ */
+bool app_mac_list_is_passed (const uint8_t * const p_mac);
+
+/**
+ * @brief Get number of addresses in active list.
+ */
+uint16_t app_mac_list_count (void);
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ *  @file app_scan_schedule.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Scan schedule uploaded by host.
+ */
+
+#include "app_scan_schedule.h"
+
+#define APP_SCAN_SCHEDULE_LEN_MASK (0x00FFU) //!< Entry count bits of state.
+#define APP_SCAN_SCHEDULE_GEN_POS  (8U)      //!< Generation bits of state.
+#define APP_SCAN_SCHEDULE_CH_MASK \
+    (APP_SCAN_SCHEDULE_CH_37 | APP_SCAN_SCHEDULE_CH_38 | APP_SCAN_SCHEDULE_CH_39)
+
+_Static_assert ((APP_SCAN_SCHEDULE_LEN > 0U)
+                && (APP_SCAN_SCHEDULE_LEN <= APP_SCAN_SCHEDULE_LEN_MASK),
+                "APP_SCAN_SCHEDULE_LEN must fit state");
+
+static app_scan_schedule_entry_t m_entries[2][APP_SCAN_SCHEDULE_LEN];
+/** @brief Generation of schedule and its entry count, generation selects buffer. */
+static volatile uint16_t m_state;
+static uint32_t m_time_ms[APP_SCAN_SCHEDULE_LEN];
+
+// Owned by scan context.
+static uint16_t m_seen_state;
+static uint8_t m_index;
+
+/** @brief Read window_ms of an entry. */
+static uint16_t app_scan_schedule_window_get (const uint8_t * const p_entry)
+{
+    return (uint16_t) (p_entry[2] | ((uint16_t) p_entry[3] << 8U));
+}
+
+/** @brief Restart from first entry if schedule has changed, return state. */
+static uint16_t app_scan_schedule_sync (void)
+{
+    const uint16_t state = m_state;
+
+    if (state != m_seen_state)
+    {
+        m_seen_state = state;
+        m_index = 0;
+    }
+
+    return state;
+}
+
+rd_status_t app_scan_schedule_set (const uint8_t * const p_entries, const size_t len)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    const size_t count = len / APP_SCAN_SCHEDULE_ENTRY_LEN;
+
+    if ((NULL == p_entries) && (0U < len))
+    {
+        err_code |= RD_ERROR_NULL;
+    }
+    else if (APP_SCAN_SCHEDULE_LEN < count)
+    {
+        err_code |= RD_ERROR_DATA_SIZE;
+    }
+    else if (0U != (len % APP_SCAN_SCHEDULE_ENTRY_LEN))
+    {
+        err_code |= RD_ERROR_INVALID_PARAM;
+    }
+    else
+    {
+        for (size_t ii = 0; (ii < count) && (RD_SUCCESS == err_code); ii++)
+        {
+            const uint8_t * const p_entry = &p_entries[ii * APP_SCAN_SCHEDULE_ENTRY_LEN];
+
+            if ((APP_SCAN_SCHEDULE_PHY_NUM <= p_entry[0])
+                    || ((APP_SCAN_SCHEDULE_PHY_CODED == p_entry[0])
+                        && (!RB_BLE_CODED_SUPPORTED))
+                    || (0U == (p_entry[1] & APP_SCAN_SCHEDULE_CH_MASK))
+                    || (0U != (p_entry[1] & (uint8_t) ~APP_SCAN_SCHEDULE_CH_MASK))
+                    || (APP_SCAN_SCHEDULE_WINDOW_MIN_MS
+                        > app_scan_schedule_window_get (p_entry)))
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+        }
+    }
+
+    if (RD_SUCCESS == err_code)
+    {
+        const uint16_t gen = (uint16_t) ((m_state >> APP_SCAN_SCHEDULE_GEN_POS) + 1U);
+        app_scan_schedule_entry_t * const p_next = m_entries[gen & 1U];
+
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            const uint8_t * const p_entry = &p_entries[ii * APP_SCAN_SCHEDULE_ENTRY_LEN];
+            p_next[ii].phy = (app_scan_schedule_phy_t) p_entry[0];
+            p_next[ii].channels.channel_37 = (0U != (p_entry[1] & APP_SCAN_SCHEDULE_CH_37));
+            p_next[ii].channels.channel_38 = (0U != (p_entry[1] & APP_SCAN_SCHEDULE_CH_38));
+            p_next[ii].channels.channel_39 = (0U != (p_entry[1] & APP_SCAN_SCHEDULE_CH_39));
+            p_next[ii].window_ms = app_scan_schedule_window_get (p_entry);
+        }
+
+        for (size_t ii = 0; ii < APP_SCAN_SCHEDULE_LEN; ii++)
+        {
+            __atomic_store_n (&m_time_ms[ii], 0U, __ATOMIC_RELAXED);
+        }
+
+        m_state = (uint16_t) ((gen << APP_SCAN_SCHEDULE_GEN_POS) | (uint16_t) count);
+    }
+
+    return err_code;
+}
+
+uint8_t app_scan_schedule_len_get (void)
+{
+    return (uint8_t) (m_state & APP_SCAN_SCHEDULE_LEN_MASK);
+}
+
+bool app_scan_schedule_entry_get (app_scan_schedule_entry_t * const p_entry)
+{
+    const uint16_t state = app_scan_schedule_sync();
+    const uint8_t count = (uint8_t) (state & APP_SCAN_SCHEDULE_LEN_MASK);
+
+    if (0U < count)
+    {
+        *p_entry = m_entries[ (state >> APP_SCAN_SCHEDULE_GEN_POS) & 1U][m_index];
+    }
+
+    return (0U < count);
+}
+
+void app_scan_schedule_advance (const uint32_t spent_ms)
+{
+    const uint16_t state = m_state;
+    const uint8_t count = (uint8_t) (state & APP_SCAN_SCHEDULE_LEN_MASK);
+
+    if ((state == m_seen_state) && (0U < count))
+    {
+        (void) __atomic_fetch_add (&m_time_ms[m_index], spent_ms, __ATOMIC_RELAXED);
+        m_index = (uint8_t) ((m_index + 1U) % count);
+    }
+}
+
+uint32_t app_scan_schedule_time_take (const uint8_t index)
+{
+    uint32_t time_ms = 0;
+
+    if (APP_SCAN_SCHEDULE_LEN > index)
+    {
+        time_ms = __atomic_exchange_n (&m_time_ms[index], 0U, __ATOMIC_RELAXED);
+    }
+
+    return time_ms;
+}
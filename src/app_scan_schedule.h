@@ -0,0 +1,103 @@
+#ifndef APP_SCAN_SCHEDULE_H
+#define APP_SCAN_SCHEDULE_H
+
+/**
+ *  @file app_scan_schedule.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Scan schedule uploaded by host.
+ *
+ *  Schedule is a list of 4-byte entries [phy, channel mask, window_ms LSB, MSB].
+ *  Scan cycles through the entries, spending window_ms on the PHY and primary
+ *  channels of each. Time actually spent on each entry is accumulated for host.
+ *  Empty schedule leaves PHY and channel selection to app_ble.
+ *
+ *  Schedule is validated when set and double buffered, so scan context never
+ *  reads a half-written schedule. Scan context starts from the first entry
+ *  when it notices a new schedule.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "app_config.h"
+#include "ruuvi_driver_error.h"
+#include "ruuvi_interface_communication_radio.h"
+
+#define APP_SCAN_SCHEDULE_ENTRY_LEN (4U)        //!< Bytes in one entry.
+#define APP_SCAN_SCHEDULE_CH_37     (1U << 0U) //!< Channel mask bit of channel 37.
+#define APP_SCAN_SCHEDULE_CH_38     (1U << 1U) //!< Channel mask bit of channel 38.
+#define APP_SCAN_SCHEDULE_CH_39     (1U << 2U) //!< Channel mask bit of channel 39.
+
+/**
+ * @brief Primary PHY of a schedule entry.
+ */
+typedef enum
+{
+    APP_SCAN_SCHEDULE_PHY_1M = 0,    //!< LE 1M PHY, and LE 2M secondary if enabled.
+    APP_SCAN_SCHEDULE_PHY_CODED = 1, //!< LE Coded PHY.
+    APP_SCAN_SCHEDULE_PHY_NUM        //!< Number of PHYs, not a valid PHY.
+} app_scan_schedule_phy_t;
+
+/**
+ * @brief Decoded schedule entry.
+ */
+typedef struct
+{
+    ri_radio_channels_t channels; //!< Primary channels to scan.
+    app_scan_schedule_phy_t phy;  //!< Primary PHY to scan.
+    uint16_t window_ms;           //!< Time to spend on entry.
+} app_scan_schedule_entry_t;
+
+/**
+ * @brief Set scan schedule.
+ *
+ * Restarts time accounting of all entries.
+ *
+ * @param[in] p_entries Entries, may be NULL if len is 0.
+ * @param[in] len Length of entries in bytes, 0 to clear schedule.
+ * @retval RD_SUCCESS On success.
+ * @retval RD_ERROR_NULL If p_entries was NULL and len was not 0.
+ * @retval RD_ERROR_DATA_SIZE If schedule has more than APP_SCAN_SCHEDULE_LEN entries.
+ * @retval RD_ERROR_INVALID_PARAM If schedule has a partial entry, an unknown or
+ *                                unsupported PHY, no channels or a window shorter
+ *                                than APP_SCAN_SCHEDULE_WINDOW_MIN_MS. Previous
+ *                                schedule stays in use.
+ */
+rd_status_t app_scan_schedule_set (const uint8_t * const p_entries, const size_t len);
+
+/**
+ * @brief Get number of entries in schedule.
+ */
+uint8_t app_scan_schedule_len_get (void);
+
+/**
+ * @brief Get entry to scan now.
+ *
+ * Call from scan context only.
+ *
+ * @param[out] p_entry Current entry.
+ * @return True if schedule has entries, false if scan is not scheduled.
+ */
+bool app_scan_schedule_entry_get (app_scan_schedule_entry_t * const p_entry);
+
+/**
+ * @brief End current entry and move to the next one.
+ *
+ * Call from scan context only. Time is not accounted if schedule has changed
+ * since current entry was taken.
+ *
+ * @param[in] spent_ms Time spent on current entry.
+ */
+void app_scan_schedule_advance (const uint32_t spent_ms);
+
+/**
+ * @brief Get time spent on an entry and clear it.
+ *
+ * @param[in] index Index of entry, 0 ... APP_SCAN_SCHEDULE_LEN - 1.
+ * @return Milliseconds spent on entry since previous take, 0 if index is out of range.
+ */
+uint32_t app_scan_schedule_time_take (const uint8_t index);
+
+#endif
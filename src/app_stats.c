@@ -0,0 +1,104 @@
+/**
+ *  @file app_stats.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Counters of advertisements and frames through each forwarding stage.
+ */
+
+#include "app_stats.h"
+#include <stddef.h>
+#include "ble_gap.h"
+
+#define APP_STATS_CH_37 (37U) //!< First primary advertising channel.
+#define APP_STATS_CH_38 (38U) //!< Second primary advertising channel.
+#define APP_STATS_CH_39 (39U) //!< Third primary advertising channel.
+
+static uint32_t m_counters[APP_STATS_NUM];
+
+void app_stats_inc (const app_stats_counter_t counter)
+{
+    if (APP_STATS_NUM > counter)
+    {
+        // Scan ISR and main context may count the same event.
+        (void) __atomic_fetch_add (&m_counters[counter], 1U, __ATOMIC_RELAXED);
+    }
+}
+
+void app_stats_rx_count (const ri_adv_scan_t * const p_scan)
+{
+    if (NULL != p_scan)
+    {
+        const uint8_t phy = (BLE_GAP_PHY_NOT_SET != p_scan->secondary_phy)
+                            ? p_scan->secondary_phy : p_scan->primary_phy;
+
+        switch (phy)
+        {
+            case BLE_GAP_PHY_1MBPS:
+                app_stats_inc (APP_STATS_RX_1MBPS);
+                break;
+
+            case BLE_GAP_PHY_2MBPS:
+                app_stats_inc (APP_STATS_RX_2MBPS);
+                break;
+
+            case BLE_GAP_PHY_CODED:
+                app_stats_inc (APP_STATS_RX_CODED);
+                break;
+
+            default:
+                // PHY not reported, counted by channel only.
+                break;
+        }
+
+        switch (p_scan->ch_index)
+        {
+            case APP_STATS_CH_37:
+                app_stats_inc (APP_STATS_RX_CH_37);
+                break;
+
+            case APP_STATS_CH_38:
+                app_stats_inc (APP_STATS_RX_CH_38);
+                break;
+
+            case APP_STATS_CH_39:
+                app_stats_inc (APP_STATS_RX_CH_39);
+                break;
+
+            default:
+                app_stats_inc (APP_STATS_RX_CH_SECONDARY);
+                break;
+        }
+    }
+}
+
+void app_stats_ch_count (const app_stats_counter_t ch_37_counter,
+                         const ri_adv_scan_t * const p_scan)
+{
+    if ((NULL != p_scan) && (APP_STATS_CH_37 <= p_scan->ch_index)
+            && (APP_STATS_CH_39 >= p_scan->ch_index))
+    {
+        app_stats_inc ((app_stats_counter_t) ((uint32_t) ch_37_counter
+                                              + (p_scan->ch_index - APP_STATS_CH_37)));
+    }
+}
+
+uint32_t app_stats_get (const app_stats_counter_t counter)
+{
+    uint32_t value = 0;
+
+    if (APP_STATS_NUM > counter)
+    {
+        value = __atomic_load_n (&m_counters[counter], __ATOMIC_RELAXED);
+    }
+
+    return value;
+}
+
+void app_stats_reset (void)
+{
+    for (uint8_t ii = 0; ii < APP_STATS_NUM; ii++)
+    {
+        __atomic_store_n (&m_counters[ii], 0U, __ATOMIC_RELAXED);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef APP_STATS_H
+#define APP_STATS_H
+
+/**
+ *  @file app_stats.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Counters of advertisements and frames through each forwarding stage.
+ *
+ *  Drops by app_adv_filter, including manufacturer filter, too long
+ *  advertisements and full advertisement pool, are counted by the filter
+ *  by reason. Counters here cover the rest of the path. Counters may be
+ *  incremented from any context and wrap around at UINT32_MAX.
+ */
+
+#include <stdint.h>
+#include "ruuvi_interface_communication_ble_advertising.h"
+
+/**
+ * @brief Counters kept, in order of APP_CA_UART_EXT_STATS reply.
+ *
+ * Append new counters at the end, host relies on the order.
+ */
+typedef enum
+{
+    APP_STATS_RX_1MBPS = 0,    //!< Advertisements received on LE 1M PHY.
+    APP_STATS_RX_2MBPS,        //!< Advertisements received on LE 2M PHY.
+    APP_STATS_RX_CODED,        //!< Advertisements received on LE Coded PHY.
+    APP_STATS_RX_CH_37,        //!< Advertisements received on channel 37.
+    APP_STATS_RX_CH_38,        //!< Advertisements received on channel 38.
+    APP_STATS_RX_CH_39,        //!< Advertisements received on channel 39.
+    APP_STATS_RX_CH_SECONDARY, //!< Advertisements received on channels 0 ... 36.
+    APP_STATS_TX_QUEUE_FULL,   //!< Advertisements dropped at full UART TX queue.
+    APP_STATS_TX_SEND_FAIL,    //!< Frames refused by UART driver.
+    APP_STATS_ENCODE_FAIL,     //!< Advertisements which could not be encoded.
+    APP_STATS_RX_PARSE_FAIL,   //!< Partial UART RX frames dropped on overflow or resync.
+    APP_STATS_SCAN_RESTART,    //!< Scans started with radio restart.
+    APP_STATS_SCAN_REARM,      //!< Scan windows re-armed without radio restart.
+    APP_STATS_ACCEPT_CH_37,    //!< Advertisements accepted by filter on channel 37.
+    APP_STATS_ACCEPT_CH_38,    //!< Advertisements accepted by filter on channel 38.
+    APP_STATS_ACCEPT_CH_39,    //!< Advertisements accepted by filter on channel 39.
+    APP_STATS_INVALID_CH_37,   //!< Malformed scan results on channel 37.
+    APP_STATS_INVALID_CH_38,   //!< Malformed scan results on channel 38.
+    APP_STATS_INVALID_CH_39,   //!< Malformed scan results on channel 39.
+    APP_STATS_NUM              //!< Number of counters.
+} app_stats_counter_t;
+
+/**
+ * @brief Increment a counter.
+ *
+ * @param[in] counter Counter to increment, ignored if out of range.
+ */
+void app_stats_inc (const app_stats_counter_t counter);
+
+/**
+ * @brief Count a received advertisement by PHY and channel.
+ *
+ * Extended advertisements are counted on their secondary PHY.
+ *
+ * @param[in] p_scan Received advertisement, ignored if NULL.
+ */
+void app_stats_rx_count (const ri_adv_scan_t * const p_scan);
+
+/**
+ * @brief Count an advertisement by primary advertising channel.
+ *
+ * @param[in] ch_37_counter Counter of channel 37, followed by those of 38 and 39.
+ * @param[in] p_scan Advertisement, ignored if NULL or not on a primary channel.
+ */
+void app_stats_ch_count (const app_stats_counter_t ch_37_counter,
+                         const ri_adv_scan_t * const p_scan);
+
+/**
+ * @brief Get a counter.
+ *
+ * @return Value of counter, 0 if counter is out of range.
+ */
+uint32_t app_stats_get (const app_stats_counter_t counter);
+
+/**
+ * @brief Clear all counters.
+ */
+void app_stats_reset (void);
+
+#endif
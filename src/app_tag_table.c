@@ -0,0 +1,76 @@
+/**
+ *  @file app_tag_table.c
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Bounded table of per-tag state, keyed by MAC address.
+ */
+
+#include "app_tag_table.h"
+#include <string.h>
+
+_Static_assert (APP_TAG_TABLE_LEN <= UINT8_MAX, "APP_TAG_TABLE_LEN must fit uint8_t");
+
+static app_tag_t m_tags[APP_TAG_TABLE_LEN];
+static uint8_t m_tag_count;
+
+app_tag_t * app_tag_table_find (const uint8_t * const p_mac)
+{
+    app_tag_t * p_tag = NULL;
+
+    for (uint8_t ii = 0; (ii < m_tag_count) && (NULL == p_tag); ii++)
+    {
+        if (0 == memcmp (m_tags[ii].mac, p_mac, APP_TAG_MAC_LEN))
+        {
+            p_tag = &m_tags[ii];
+        }
+    }
+
+    return p_tag;
+}
+
+app_tag_t * app_tag_table_get (const uint8_t * const p_mac, const uint32_t now_ms,
+                               bool * const p_is_new)
+{
+    app_tag_t * p_tag = NULL;
+    app_tag_t * p_oldest = &m_tags[0];
+
+    for (uint8_t ii = 0; (ii < m_tag_count) && (NULL == p_tag); ii++)
+    {
+        if (0 == memcmp (m_tags[ii].mac, p_mac, APP_TAG_MAC_LEN))
+        {
+            p_tag = &m_tags[ii];
+        }
+        // Unsigned subtraction keeps order across clock wraparound.
+        else if ((now_ms - m_tags[ii].last_seen_ms) > (now_ms - p_oldest->last_seen_ms))
+        {
+            p_oldest = &m_tags[ii];
+        }
+        else
+        {
+            // No action needed.
+        }
+    }
+
+    *p_is_new = (NULL == p_tag);
+
+    if (*p_is_new)
+    {
+        p_tag = (APP_TAG_TABLE_LEN > m_tag_count) ? &m_tags[m_tag_count++] : p_oldest;
+        memset (p_tag, 0, sizeof (*p_tag));
+        memcpy (p_tag->mac, p_mac, APP_TAG_MAC_LEN);
+    }
+
+    p_tag->last_seen_ms = now_ms;
+    return p_tag;
+}
+
+uint8_t app_tag_table_count (void)
+{
+    return m_tag_count;
+}
+
+void app_tag_table_clear (void)
+{
+    m_tag_count = 0;
+}
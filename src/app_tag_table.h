@@ -0,0 +1,67 @@
+#ifndef APP_TAG_TABLE_H
+#define APP_TAG_TABLE_H
+
+/**
+ *  @file app_tag_table.h
+ *  @date 2026-10-17
+ *  @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ *
+ *  Bounded table of per-tag state, keyed by MAC address.
+ *
+ *  Table holds APP_TAG_TABLE_LEN entries, least recently seen entry is
+ *  evicted to make room for a new tag. Lookup is linear, which is faster
+ *  than hashing at this size. Table is not locked, all calls must come
+ *  from the same context, i.e. scan ISR via app_adv_filter.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_config.h"
+
+#define APP_TAG_MAC_LEN (6U) //!< Bytes in BLE MAC address.
+
+/**
+ * @brief State of one tag.
+ */
+typedef struct
+{
+    uint8_t mac[APP_TAG_MAC_LEN]; //!< MAC address of tag.
+    bool in_range;                //!< RSSI has been above floor, see app_adv_filter.
+    bool is_forwarded;            //!< A report of tag has been forwarded.
+    uint32_t last_seen_ms;        //!< Time tag was last looked up, for LRU.
+    uint32_t fingerprint;         //!< Hash of last forwarded payload.
+    uint32_t forwarded_ms;        //!< Time of last forwarded payload.
+} app_tag_t;
+
+/**
+ * @brief Get entry of given tag, creating it if needed.
+ *
+ * New entries are zeroed apart from MAC and last_seen_ms.
+ *
+ * @param[in] p_mac MAC address of tag.
+ * @param[in] now_ms Current time, stored as last seen time.
+ * @param[out] p_is_new True if entry was created by this call.
+ * @return Entry of tag, never NULL.
+ */
+app_tag_t * app_tag_table_get (const uint8_t * const p_mac, const uint32_t now_ms,
+                               bool * const p_is_new);
+
+/**
+ * @brief Find entry of given tag without creating it.
+ *
+ * @param[in] p_mac MAC address of tag.
+ * @return Entry of tag, NULL if tag is not in table.
+ */
+app_tag_t * app_tag_table_find (const uint8_t * const p_mac);
+
+/**
+ * @brief Get number of tags in table.
+ */
+uint8_t app_tag_table_count (void);
+
+/**
+ * @brief Remove all tags from table.
+ */
+void app_tag_table_clear (void);
+
+#endif
@@ -13,6 +13,14 @@
 #include "app_config.h"
 #include "app_uart.h"
 #include <string.h>
+#include "app_adv_filter.h"
+#include "app_adv_match.h"
+#include "app_ca_uart_ext.h"
+#include "app_clock.h"
+#include "app_latency.h"
+#include "app_mac_list.h"
+#include "app_scan_schedule.h"
+#include "app_stats.h"
 #include "ble_gap.h"
 #include "app_ble.h"
 #include "main.h"
@@ -38,7 +46,7 @@
 #endif
 
 #define APP_UART_RING_BUFFER_MAX_LEN     (128U) //!< Ring buffer len       
-#define APP_UART_RING_DEQ_BUFFER_MAX_LEN (APP_UART_RING_BUFFER_MAX_LEN >>1) //!< Decode buffer len
+#define APP_UART_RING_DEQ_BUFFER_MAX_LEN (APP_UART_RING_BUFFER_MAX_LEN) //!< Decode buffer len
 
 /*!
  * @brief UART response type enum
@@ -48,8 +56,48 @@ typedef enum
     APP_UART_RESP_TYPE_NONE = 0,  //!< No response
     APP_UART_RESP_TYPE_ACK,       //!< Ack response
     APP_UART_RESP_TYPE_DEVICE_ID, //!< Device ID response
+    APP_UART_RESP_TYPE_EXT_ACK,   //!< Ack response to an extension command
+    APP_UART_RESP_TYPE_EXT_REPLY, //!< Reply to an extension query
 } app_uart_resp_type_e;
 
+/*!
+ * @brief Forwarding times of an advertisement frame, app_clock RTC ticks.
+ *
+ * A batch frame carries the times of its first advertisement.
+ */
+typedef struct
+{
+    uint32_t rx_ticks;  //!< Advertisement was received in scan ISR.
+    uint32_t deq_ticks; //!< Advertisement was taken from pool.
+} app_uart_tx_stamp_t;
+
+/*!
+ * @brief Queue of encoded advertisement frames waiting for UART TX.
+ */
+typedef struct
+{
+    ri_comm_message_t frames[APP_UART_TX_QUEUE_LEN]; //!< Encoded frames.
+    app_uart_tx_stamp_t stamps[APP_UART_TX_QUEUE_LEN]; //!< Forwarding times of frames.
+    uint8_t head;                                    //!< Index of oldest frame.
+    uint8_t count;                                   //!< Number of queued frames.
+    bool batch_open;                                 //!< Last frame is an open batch.
+} app_uart_tx_queue_t;
+
+_Static_assert (APP_UART_TX_QUEUE_LEN <= UINT8_MAX, "TX queue index must fit uint8_t");
+_Static_assert ((APP_CA_UART_EXT_OVERHEAD
+                 + (APP_CA_UART_EXT_MAC_LIST_ADD_MAX * APP_MAC_LIST_MAC_LEN))
+                < APP_UART_RING_BUFFER_MAX_LEN,
+                "Largest MAC_LIST_ADD frame must fit RX ring buffer");
+
+/*!
+ * @brief Frame being sent, latency is recorded at TX complete.
+ */
+typedef struct
+{
+    app_uart_tx_stamp_t stamp; //!< Forwarding times of frame.
+    bool is_adv;               //!< Frame carries advertisements, stamp is valid.
+} app_uart_tx_flight_t;
+
 #ifndef CEEDLING
 static bool app_uart_ringbuffer_lock_dummy (volatile uint32_t * const flag, bool lock);
 #endif
@@ -62,8 +110,14 @@ static bool buffer_rlock = false;
 static bool g_flag_uart_tx_in_progress;
 static app_uart_resp_type_e g_resp_type;
 static re_ca_uart_cmd_t g_resp_ack_cmd;
+static uint8_t g_resp_ext_cmd;
+static uint8_t g_resp_ext_arg; //!< Argument of extension query, e.g. latency stage.
 static bool g_resp_ack_state;
 static re_ca_uart_payload_t m_uart_payload;
+static app_uart_tx_queue_t m_tx_queue;
+static volatile app_uart_tx_flight_t m_tx_flight;
+static app_ca_uart_ext_report_mode_t m_report_mode;
+static uint8_t m_report_batch_max;
 
 #ifndef CEEDLING
 static
@@ -105,10 +159,18 @@ void app_uart_init_globs (void)
     g_flag_uart_tx_in_progress = false;
     g_resp_type = APP_UART_RESP_TYPE_NONE;
     g_resp_ack_cmd = (re_ca_uart_cmd_t)0;
+    g_resp_ext_cmd = 0;
+    g_resp_ext_arg = 0;
     g_resp_ack_state = false;
     m_uart_ack = false;
     m_uart_ring_buffer.head = 0;
     m_uart_ring_buffer.tail = 0;
+    m_tx_queue.head = 0;
+    m_tx_queue.count = 0;
+    m_tx_queue.batch_open = false;
+    m_tx_flight.is_adv = false;
+    m_report_mode = APP_CA_UART_EXT_REPORT_SINGLE;
+    m_report_batch_max = UINT8_MAX;
 }
 
 /** Dummy function to lock/unlock buffer */
@@ -125,8 +187,24 @@ bool app_uart_ringbuffer_lock_dummy (volatile uint32_t * const flag, bool lock)
     return true;
 }
 
-static rd_status_t app_uart_send_msg (ri_comm_message_t * const p_msg)
+/**
+ * @brief Send a frame.
+ *
+ * @param[in] p_msg Frame to send.
+ * @param[in] p_stamp Forwarding times of an advertisement frame, NULL for other frames.
+ */
+static rd_status_t app_uart_send_msg (ri_comm_message_t * const p_msg,
+                                      const app_uart_tx_stamp_t * const p_stamp)
 {
+    // Set before sending, TX complete may interrupt before send returns.
+    m_tx_flight.is_adv = (NULL != p_stamp);
+
+    if (NULL != p_stamp)
+    {
+        m_tx_flight.stamp.rx_ticks = p_stamp->rx_ticks;
+        m_tx_flight.stamp.deq_ticks = p_stamp->deq_ticks;
+    }
+
     g_flag_uart_tx_in_progress = true;
     const rd_status_t err_code = m_uart.send (p_msg);
 
@@ -138,6 +216,184 @@ static rd_status_t app_uart_send_msg (ri_comm_message_t * const p_msg)
     return err_code;
 }
 
+/** @brief Get queue slot at given offset from head. */
+static ri_comm_message_t * app_uart_tx_queue_slot (const uint8_t offset)
+{
+    return &m_tx_queue.frames[ (m_tx_queue.head + offset) % APP_UART_TX_QUEUE_LEN];
+}
+
+/** @brief Get forwarding times of queue slot at given offset from head. */
+static app_uart_tx_stamp_t * app_uart_tx_queue_stamp (const uint8_t offset)
+{
+    return &m_tx_queue.stamps[ (m_tx_queue.head + offset) % APP_UART_TX_QUEUE_LEN];
+}
+
+/** @brief Finalize open batch frame at the end of queue, if any. */
+static void app_uart_tx_queue_batch_close (void)
+{
+    if (m_tx_queue.batch_open)
+    {
+        ri_comm_message_t * const p_msg = app_uart_tx_queue_slot (m_tx_queue.count - 1U);
+        app_ca_uart_ext_batch_close (p_msg->data, &p_msg->data_length);
+        m_tx_queue.batch_open = false;
+    }
+}
+
+/**
+ * @brief Send the oldest queued frame if UART is idle.
+ *
+ * Frame is removed from queue even if driver refuses it, a failed frame is
+ * counted as dropped so that a stuck driver cannot stall the queue.
+ */
+static rd_status_t app_uart_tx_queue_kick (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    if ((!g_flag_uart_tx_in_progress) && (0U < m_tx_queue.count))
+    {
+        ri_comm_message_t * const p_head = &m_tx_queue.frames[m_tx_queue.head];
+
+        if (1U == m_tx_queue.count)
+        {
+            app_uart_tx_queue_batch_close();
+        }
+
+        err_code |= app_uart_send_msg (p_head, app_uart_tx_queue_stamp (0));
+        m_tx_queue.head = (uint8_t) ((m_tx_queue.head + 1U) % APP_UART_TX_QUEUE_LEN);
+        m_tx_queue.count--;
+
+        if (RD_SUCCESS != err_code)
+        {
+            app_stats_inc (APP_STATS_TX_SEND_FAIL);
+        }
+    }
+
+    return err_code;
+}
+
+/**
+ * @brief Reserve the slot after the last queued frame for encoding in place.
+ *
+ * Slot is not part of queue until @ref app_uart_tx_queue_commit is called,
+ * an unused reservation needs no cleanup.
+ *
+ * @param[in] p_stamp Forwarding times of advertisement to encode.
+ * @return Pointer to free slot, NULL if queue was full. Full queue counts a drop.
+ */
+static ri_comm_message_t * app_uart_tx_queue_reserve (const app_uart_tx_stamp_t * const
+        p_stamp)
+{
+    ri_comm_message_t * p_msg = NULL;
+
+    if (APP_UART_TX_QUEUE_LEN <= m_tx_queue.count)
+    {
+        app_stats_inc (APP_STATS_TX_QUEUE_FULL);
+    }
+    else
+    {
+        app_uart_tx_queue_batch_close();
+        p_msg = app_uart_tx_queue_slot (m_tx_queue.count);
+        *app_uart_tx_queue_stamp (m_tx_queue.count) = *p_stamp;
+    }
+
+    return p_msg;
+}
+
+/**
+ * @brief Append reserved slot to queue and start sending it if UART is idle.
+ *
+ * @retval RD_SUCCESS If frame was sent or queued.
+ * @return Error code from driver if sending failed.
+ */
+static rd_status_t app_uart_tx_queue_commit (void)
+{
+    m_tx_queue.count++;
+    return app_uart_tx_queue_kick();
+}
+
+/**
+ * @brief Append an advertisement to the open batch frame at the end of TX queue.
+ *
+ * A new batch frame is started if there is no open batch or if the open one
+ * is full.
+ *
+ * @param[in] p_adv Advertisement to add.
+ * @param[in] p_stamp Forwarding times of advertisement, kept if it starts a frame.
+ * @retval RD_SUCCESS If advertisement was batched.
+ * @retval RD_ERROR_NO_MEM If queue was full and advertisement was dropped.
+ */
+static rd_status_t app_uart_tx_queue_batch_add (const re_ca_uart_ble_adv_t * const p_adv,
+        const app_uart_tx_stamp_t * const p_stamp)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    bool is_added = false;
+
+    if (m_tx_queue.batch_open)
+    {
+        ri_comm_message_t * const p_msg = app_uart_tx_queue_slot (m_tx_queue.count - 1U);
+        is_added = (m_report_batch_max > app_ca_uart_ext_batch_count (p_msg->data))
+                   && (RD_SUCCESS == app_ca_uart_ext_batch_add (p_msg->data, &p_msg->data_length,
+                           sizeof (p_msg->data), p_adv));
+
+        if (!is_added)
+        {
+            app_uart_tx_queue_batch_close();
+        }
+    }
+
+    if (is_added)
+    {
+        // No action needed.
+    }
+    else if (APP_UART_TX_QUEUE_LEN <= m_tx_queue.count)
+    {
+        app_stats_inc (APP_STATS_TX_QUEUE_FULL);
+        err_code |= RD_ERROR_NO_MEM;
+    }
+    else
+    {
+        ri_comm_message_t * const p_msg = app_uart_tx_queue_slot (m_tx_queue.count);
+        p_msg->repeat_count = 1;
+        *app_uart_tx_queue_stamp (m_tx_queue.count) = *p_stamp;
+        app_ca_uart_ext_batch_init (p_msg->data, &p_msg->data_length);
+        err_code |= app_ca_uart_ext_batch_add (p_msg->data, &p_msg->data_length,
+                                               sizeof (p_msg->data), p_adv);
+
+        if (RD_SUCCESS != err_code)
+        {
+            app_stats_inc (APP_STATS_ENCODE_FAIL);
+        }
+
+        m_tx_queue.count++;
+        m_tx_queue.batch_open = true;
+    }
+
+    err_code |= app_uart_tx_queue_kick();
+    return err_code;
+}
+
+uint32_t app_uart_tx_drops_get (void)
+{
+    return app_stats_get (APP_STATS_TX_QUEUE_FULL) + app_stats_get (APP_STATS_TX_SEND_FAIL);
+}
+
+bool app_uart_tx_queue_is_full (void)
+{
+    bool is_full = (APP_UART_TX_QUEUE_LEN <= m_tx_queue.count);
+
+    // Open batch in a full queue takes advertisements while it has room for any.
+    if (is_full && m_tx_queue.batch_open)
+    {
+        const ri_comm_message_t * const p_msg = app_uart_tx_queue_slot (m_tx_queue.count - 1U);
+        is_full = (m_report_batch_max <= app_ca_uart_ext_batch_count (p_msg->data))
+                  || ((sizeof (p_msg->data) - p_msg->data_length)
+                      < (APP_CA_UART_EXT_ADV_RECORD_HEADER_LEN + RE_CA_UART_ADV_BYTES
+                         + APP_CA_UART_EXT_TRAILER_LEN));
+    }
+
+    return is_full;
+}
+
 static rd_status_t app_uart_send_device_id (void)
 {
     rd_status_t err_code = RD_SUCCESS;
@@ -154,7 +410,7 @@ static rd_status_t app_uart_send_device_id (void)
     m_uart_payload.params.device_id.addr = mac;
     err_code |= re_ca_uart_encode (m_msg.data, &m_msg.data_length, &m_uart_payload);
     m_msg.repeat_count = 1;
-    err_code |= app_uart_send_msg (&m_msg);
+    err_code |= app_uart_send_msg (&m_msg, NULL);
     return err_code;
 }
 
@@ -181,7 +437,7 @@ static rd_status_t app_uart_send_ack (const re_ca_uart_cmd_t cmd, const bool is_
 
     if (RE_SUCCESS == err_code)
     {
-        err_code |= app_uart_send_msg (&m_msg);
+        err_code |= app_uart_send_msg (&m_msg, NULL);
     }
     else
     {
@@ -191,6 +447,203 @@ static rd_status_t app_uart_send_ack (const re_ca_uart_cmd_t cmd, const bool is_
     return err_code;
 }
 
+static rd_status_t app_uart_send_ext_ack (const uint8_t cmd, const bool is_ok)
+{
+    const uint8_t payload[] =
+    {
+        cmd,
+        (uint8_t) (is_ok ? RE_CA_ACK_OK : RE_CA_ACK_ERROR)
+    };
+    ri_comm_message_t m_msg;
+    memset (&m_msg, 0, sizeof (m_msg));
+    m_msg.data_length = sizeof (m_msg.data);
+    rd_status_t err_code = app_ca_uart_ext_encode (m_msg.data, &m_msg.data_length,
+                           APP_CA_UART_EXT_ACK, payload, sizeof (payload));
+    m_msg.repeat_count = 1;
+
+    if (RD_SUCCESS == err_code)
+    {
+        err_code |= app_uart_send_msg (&m_msg, NULL);
+    }
+
+    return err_code;
+}
+
+/** @brief Write a uint32 to extension payload, LSB first. */
+static uint8_t app_uart_ext_u32_put (uint8_t * const p_data, const uint32_t value)
+{
+    for (uint8_t ii = 0; ii < sizeof (value); ii++)
+    {
+        p_data[ii] = (uint8_t) (value >> (8U * ii));
+    }
+
+    return (uint8_t) sizeof (value);
+}
+
+/** @brief Largest extension reply payload which fits one UART message. */
+#define APP_UART_EXT_REPLY_PAYLOAD_MAX \
+    (sizeof (((ri_comm_message_t *) 0)->data) - APP_CA_UART_EXT_OVERHEAD)
+
+_Static_assert ((APP_CA_UART_EXT_DROPS_COUNTERS_POS
+                 + ((APP_ADV_FILTER_REASON_NUM - 1U) * sizeof (uint32_t)))
+                <= APP_UART_EXT_REPLY_PAYLOAD_MAX, "Drop counters must fit one reply");
+
+/** @brief Encode reply payload of GET_DROPS. */
+static uint8_t app_uart_ext_drops_encode (uint8_t * const p_payload)
+{
+    uint8_t len = APP_CA_UART_EXT_DROPS_COUNTERS_POS;
+    p_payload[0] = (uint8_t) app_adv_filter_shed_level_get();
+    p_payload[1] = (uint8_t) (APP_ADV_FILTER_REASON_NUM - 1U);
+
+    for (uint8_t reason = APP_ADV_FILTER_REJECT_INVALID;
+            reason < APP_ADV_FILTER_REASON_NUM; reason++)
+    {
+        len += app_uart_ext_u32_put (&p_payload[len],
+                                     app_adv_filter_rejects_get ((app_adv_filter_reason_t) reason));
+    }
+
+    return len;
+}
+
+/** @brief Encode reply payload of GET_QUEUE_AGE. */
+static uint8_t app_uart_ext_queue_age_encode (uint8_t * const p_payload)
+{
+    app_ble_adv_age_t age = {0};
+    uint8_t len = 0;
+    app_ble_adv_age_take (&age);
+    len += app_uart_ext_u32_put (&p_payload[len], age.count);
+    len += app_uart_ext_u32_put (&p_payload[len], age.mean_ms);
+    len += app_uart_ext_u32_put (&p_payload[len], age.max_ms);
+    return len;
+}
+
+_Static_assert ((APP_CA_UART_EXT_LATENCY_COUNTS_POS
+                 + (APP_LATENCY_BUCKETS * sizeof (uint16_t)))
+                <= APP_UART_EXT_REPLY_PAYLOAD_MAX, "Latency histogram must fit one reply");
+
+/**
+ * @brief Encode reply payload of GET_LATENCY.
+ *
+ * @param[out] p_payload Reply payload.
+ * @param[in] stage Stage to reply with, checked by caller.
+ */
+static uint8_t app_uart_ext_latency_encode (uint8_t * const p_payload,
+        const app_latency_stage_t stage)
+{
+    uint8_t len = APP_CA_UART_EXT_LATENCY_COUNTS_POS;
+    p_payload[0] = (uint8_t) stage;
+    p_payload[1] = (uint8_t) APP_LATENCY_BUCKETS;
+
+    for (uint8_t bucket = 0; bucket < APP_LATENCY_BUCKETS; bucket++)
+    {
+        const uint16_t count = app_latency_take (stage, bucket);
+        p_payload[len++] = (uint8_t) count;
+        p_payload[len++] = (uint8_t) (count >> 8U);
+    }
+
+    return len;
+}
+
+_Static_assert ((APP_CA_UART_EXT_STATS_COUNTERS_POS + (APP_STATS_NUM * sizeof (uint32_t)))
+                <= APP_UART_EXT_REPLY_PAYLOAD_MAX, "Counters must fit one reply");
+
+/** @brief Encode reply payload of GET_STATS. */
+static uint8_t app_uart_ext_stats_encode (uint8_t * const p_payload)
+{
+    uint8_t len = APP_CA_UART_EXT_STATS_COUNTERS_POS;
+    p_payload[0] = (uint8_t) APP_STATS_NUM;
+
+    for (uint8_t counter = 0; counter < APP_STATS_NUM; counter++)
+    {
+        len += app_uart_ext_u32_put (&p_payload[len],
+                                     app_stats_get ((app_stats_counter_t) counter));
+    }
+
+    return len;
+}
+
+_Static_assert ((APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS
+                 + (APP_SCAN_SCHEDULE_LEN * sizeof (uint32_t)))
+                <= APP_UART_EXT_REPLY_PAYLOAD_MAX, "Schedule times must fit one reply");
+
+/** @brief Encode reply payload of GET_SCAN_SCHEDULE_TIME. */
+static uint8_t app_uart_ext_schedule_time_encode (uint8_t * const p_payload)
+{
+    uint8_t len = APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS;
+    const uint8_t count = app_scan_schedule_len_get();
+    p_payload[0] = count;
+
+    for (uint8_t index = 0; index < count; index++)
+    {
+        len += app_uart_ext_u32_put (&p_payload[len], app_scan_schedule_time_take (index));
+    }
+
+    return len;
+}
+
+/**
+ * @brief Send reply to an extension query.
+ *
+ * @param[in] cmd Query to reply to.
+ * @param[in] arg Argument of query, e.g. latency stage.
+ */
+static rd_status_t app_uart_send_ext_reply (const uint8_t cmd, const uint8_t arg)
+{
+    uint8_t payload[APP_UART_EXT_REPLY_PAYLOAD_MAX];
+    uint8_t reply = APP_CA_UART_EXT_ACK;
+    uint8_t len = 0;
+    rd_status_t err_code = RD_SUCCESS;
+
+    switch (cmd)
+    {
+        case APP_CA_UART_EXT_GET_DROPS:
+            reply = APP_CA_UART_EXT_DROPS;
+            len = app_uart_ext_drops_encode (payload);
+            break;
+
+        case APP_CA_UART_EXT_GET_QUEUE_AGE:
+            reply = APP_CA_UART_EXT_QUEUE_AGE;
+            len = app_uart_ext_queue_age_encode (payload);
+            break;
+
+        case APP_CA_UART_EXT_GET_LATENCY:
+            reply = APP_CA_UART_EXT_LATENCY;
+            len = app_uart_ext_latency_encode (payload, (app_latency_stage_t) arg);
+            break;
+
+        case APP_CA_UART_EXT_GET_STATS:
+            reply = APP_CA_UART_EXT_STATS;
+            len = app_uart_ext_stats_encode (payload);
+            break;
+
+        case APP_CA_UART_EXT_GET_SCAN_SCHEDULE_TIME:
+            reply = APP_CA_UART_EXT_SCAN_SCHEDULE_TIME;
+            len = app_uart_ext_schedule_time_encode (payload);
+            break;
+
+        default:
+            err_code |= RD_ERROR_NOT_SUPPORTED;
+            break;
+    }
+
+    if (RD_SUCCESS == err_code)
+    {
+        ri_comm_message_t m_msg;
+        memset (&m_msg, 0, sizeof (m_msg));
+        m_msg.data_length = sizeof (m_msg.data);
+        err_code |= app_ca_uart_ext_encode (m_msg.data, &m_msg.data_length, reply,
+                                            payload, len);
+        m_msg.repeat_count = 1;
+
+        if (RD_SUCCESS == err_code)
+        {
+            err_code |= app_uart_send_msg (&m_msg, NULL);
+        }
+    }
+
+    return err_code;
+}
+
 #ifndef CEEDLING
 static
 #endif
@@ -203,6 +656,7 @@ void app_uart_on_evt_tx_finish (void * p_data, uint16_t data_len)
     switch (g_resp_type)
     {
         case APP_UART_RESP_TYPE_NONE:
+            (void) app_uart_tx_queue_kick();
             return;
 
         case APP_UART_RESP_TYPE_ACK:
@@ -214,6 +668,16 @@ void app_uart_on_evt_tx_finish (void * p_data, uint16_t data_len)
             g_resp_type = APP_UART_RESP_TYPE_NONE;
             app_uart_send_device_id();
             return;
+
+        case APP_UART_RESP_TYPE_EXT_ACK:
+            g_resp_type = APP_UART_RESP_TYPE_NONE;
+            app_uart_send_ext_ack (g_resp_ext_cmd, g_resp_ack_state);
+            return;
+
+        case APP_UART_RESP_TYPE_EXT_REPLY:
+            g_resp_type = APP_UART_RESP_TYPE_NONE;
+            app_uart_send_ext_reply (g_resp_ext_cmd, g_resp_ext_arg);
+            return;
     }
 
     NRF_LOG_ERROR ("%s: unknown response type: %d", __func__, g_resp_type);
@@ -249,6 +713,293 @@ void app_uart_on_evt_send_ack (void * p_data, uint16_t data_len)
     }
 }
 
+#ifndef CEEDLING
+static
+#endif
+void app_uart_on_evt_send_ext_ack (void * p_data, uint16_t data_len)
+{
+    (void)p_data;
+    (void)data_len;
+    g_resp_type = APP_UART_RESP_TYPE_EXT_ACK;
+
+    if (!g_flag_uart_tx_in_progress)
+    {
+        ri_scheduler_event_put (NULL, (uint16_t)0, app_uart_on_evt_tx_finish);
+    }
+}
+
+#ifndef CEEDLING
+static
+#endif
+void app_uart_on_evt_send_ext_reply (void * p_data, uint16_t data_len)
+{
+    (void)p_data;
+    (void)data_len;
+    g_resp_type = APP_UART_RESP_TYPE_EXT_REPLY;
+
+    if (!g_flag_uart_tx_in_progress)
+    {
+        ri_scheduler_event_put (NULL, (uint16_t)0, app_uart_on_evt_tx_finish);
+    }
+}
+
+/** @brief Read a little-endian uint16 from extension payload. */
+static uint16_t app_uart_ext_u16_get (const uint8_t * const p_data)
+{
+    return (uint16_t) (p_data[0] | ((uint16_t) p_data[1] << 8U));
+}
+
+static rd_status_t app_uart_apply_ext_config (const app_ca_uart_ext_frame_t * const p_frame)
+{
+    rd_status_t err_code = RD_SUCCESS;
+
+    switch (p_frame->cmd)
+    {
+        case APP_CA_UART_EXT_SET_REPORT_MODE:
+            if ((2U > p_frame->payload_len)
+                    || (APP_CA_UART_EXT_REPORT_BATCH < p_frame->p_payload[0]))
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                m_report_mode = (app_ca_uart_ext_report_mode_t) p_frame->p_payload[0];
+                m_report_batch_max = (0U == p_frame->p_payload[1])
+                                     ? UINT8_MAX
+                                     : p_frame->p_payload[1];
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_DEDUP_WINDOW:
+            if (2U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                app_adv_filter_dedup_window_set (app_uart_ext_u16_get (p_frame->p_payload));
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_RATE_LIMIT:
+            if (2U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_adv_filter_rate_limit_set (
+                                app_uart_ext_u16_get (p_frame->p_payload));
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_RSSI_FLOOR:
+            if (2U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                app_adv_filter_rssi_floor_set ((int8_t) p_frame->p_payload[0],
+                                               p_frame->p_payload[1]);
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_MAC_LIST_CLEAR:
+            app_mac_list_clear();
+            break;
+
+        case APP_CA_UART_EXT_MAC_LIST_ADD:
+            if ((0U != (p_frame->payload_len % APP_MAC_LIST_MAC_LEN))
+                    || ((APP_CA_UART_EXT_MAC_LIST_ADD_MAX * APP_MAC_LIST_MAC_LEN)
+                        < p_frame->payload_len))
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_mac_list_add (p_frame->p_payload,
+                                              p_frame->payload_len / APP_MAC_LIST_MAC_LEN);
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_MAC_LIST_MODE:
+            if (1U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_mac_list_mode_set (
+                                (app_mac_list_mode_t) p_frame->p_payload[0]);
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_MANUFACTURER_IDS:
+            // Flags byte followed by whole IDs.
+            if ((1U > p_frame->payload_len) || (0U == (p_frame->payload_len % 2U))
+                    || ((1U + (2U * APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX))
+                        < p_frame->payload_len))
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                const uint8_t flags = p_frame->p_payload[0];
+                const size_t count = (p_frame->payload_len - 1U) / 2U;
+                uint16_t ids[APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX] = {0};
+
+                for (size_t ii = 0; ii < count; ii++)
+                {
+                    ids[ii] = app_uart_ext_u16_get (&p_frame->p_payload[1U + (2U * ii)]);
+                }
+
+                err_code |= app_adv_filter_manufacturer_extra_set (ids, count,
+                            0U != (flags & APP_CA_UART_EXT_MANUFACTURER_ACCEPT_NONE));
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_MATCH_PROGRAM:
+            err_code |= app_adv_match_program_set (p_frame->p_payload, p_frame->payload_len);
+            break;
+
+        case APP_CA_UART_EXT_SET_MAX_AGE:
+            if (2U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                app_ble_adv_max_age_set (app_uart_ext_u16_get (p_frame->p_payload));
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_RESET_STATS:
+            app_stats_reset();
+            app_adv_filter_rejects_reset();
+            break;
+
+        case APP_CA_UART_EXT_SET_SCAN_MODE:
+            if (1U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_ble_scan_mode_set (
+                                (app_ble_scan_mode_t) p_frame->p_payload[0]);
+
+                if (RD_SUCCESS == err_code)
+                {
+                    err_code |= app_ble_scan_start(); // Applies new scan mode.
+                }
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_PHY_SHARE:
+            if (2U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_ble_phy_share_set (p_frame->p_payload[0],
+                                                   p_frame->p_payload[1]);
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_SCAN_TIMING:
+            if (6U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_ble_scan_timing_set (
+                                app_uart_ext_u16_get (&p_frame->p_payload[0]),
+                                app_uart_ext_u16_get (&p_frame->p_payload[2]),
+                                app_uart_ext_u16_get (&p_frame->p_payload[4]));
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_CHANNEL_DWELL:
+            if (3U > p_frame->payload_len)
+            {
+                err_code |= RD_ERROR_INVALID_PARAM;
+            }
+            else
+            {
+                err_code |= app_ble_channel_dwell_set (0U != p_frame->p_payload[0],
+                                                       p_frame->p_payload[1],
+                                                       p_frame->p_payload[2]);
+            }
+
+            break;
+
+        case APP_CA_UART_EXT_SET_SCAN_SCHEDULE:
+            err_code |= app_scan_schedule_set (p_frame->p_payload, p_frame->payload_len);
+
+            if (RD_SUCCESS == err_code)
+            {
+                err_code |= app_ble_scan_start(); // Starts from first entry.
+            }
+
+            break;
+
+        default:
+            err_code |= RD_ERROR_NOT_SUPPORTED;
+            break;
+    }
+
+    return err_code;
+}
+
+/**
+ * @brief Answer an extension query or apply an extension command and schedule its ACK.
+ */
+static void app_uart_ext_parser (const app_ca_uart_ext_frame_t * const p_frame)
+{
+    // Query of an unknown stage is not a query, it is NACKed as unsupported command.
+    const bool is_latency_query = (APP_CA_UART_EXT_GET_LATENCY == p_frame->cmd)
+                                  && (APP_CA_UART_EXT_GET_LATENCY_LEN == p_frame->payload_len)
+                                  && (APP_LATENCY_STAGE_NUM > p_frame->p_payload[0]);
+
+    if ((APP_CA_UART_EXT_GET_DROPS == p_frame->cmd)
+            || (APP_CA_UART_EXT_GET_QUEUE_AGE == p_frame->cmd)
+            || is_latency_query
+            || (APP_CA_UART_EXT_GET_STATS == p_frame->cmd)
+            || (APP_CA_UART_EXT_GET_SCAN_SCHEDULE_TIME == p_frame->cmd))
+    {
+        g_resp_ext_cmd = p_frame->cmd;
+        g_resp_ext_arg = is_latency_query ? p_frame->p_payload[0] : 0U;
+        ri_scheduler_event_put (NULL, (uint16_t) 0, app_uart_on_evt_send_ext_reply);
+    }
+    else
+    {
+        const rd_status_t err_code = app_uart_apply_ext_config (p_frame);
+        g_resp_ext_cmd = p_frame->cmd;
+        g_resp_ack_state = (RD_SUCCESS == err_code);
+
+        if (!g_resp_ack_state)
+        {
+            NRF_LOG_ERROR ("%s: ext cmd 0x%02x, err=%d", __func__, p_frame->cmd, err_code);
+        }
+
+        ri_scheduler_event_put (NULL, (uint16_t) 0, app_uart_on_evt_send_ext_ack);
+    }
+}
+
 #ifndef CEEDLING
 static
 rd_status_t app_uart_apply_config (re_ca_uart_payload_t * p_uart_payload)
@@ -362,7 +1113,7 @@ void app_uart_repeat_send (void * p_data, uint16_t data_len)
     msg.repeat_count = 1;
     msg.data_length = data_len;
     memcpy (msg.data, p_data, data_len);
-    err_code |= app_uart_send_msg (&msg);
+    err_code |= app_uart_send_msg (&msg, NULL);
 
     if (RE_SUCCESS != err_code)
     {
@@ -386,6 +1137,14 @@ void app_uart_parser (void * p_data, uint16_t data_len)
     uint8_t dequeue_data[APP_UART_RING_DEQ_BUFFER_MAX_LEN] = {0};
     rl_status_t status = RL_SUCCESS;
     size_t index = 0;
+    app_ca_uart_ext_frame_t ext_frame = {0};
+
+    if (RD_SUCCESS == app_ca_uart_ext_decode ((uint8_t *) p_data, data_len, &ext_frame))
+    {
+        app_uart_ext_parser (&ext_frame);
+        return;
+    }
+
     memset (&m_uart_payload, 0, sizeof (m_uart_payload));
     err_code = re_ca_uart_decode ((uint8_t *) p_data, &m_uart_payload);
 
@@ -402,6 +1161,12 @@ void app_uart_parser (void * p_data, uint16_t data_len)
                 dequeue_data[index++] = *p_dequeue_data;
             }
         } while (RL_SUCCESS == status);
+
+        // Partial frame left over from earlier chunks is dropped.
+        if (0U < index)
+        {
+            app_stats_inc (APP_STATS_RX_PARSE_FAIL);
+        }
     }
     else
     {
@@ -413,6 +1178,7 @@ void app_uart_parser (void * p_data, uint16_t data_len)
             index++;
         } while ((RL_SUCCESS == status) && (index < data_len));
 
+        const bool is_overflow = (RL_SUCCESS != status);
         index = 0;
 
         do
@@ -427,6 +1193,12 @@ void app_uart_parser (void * p_data, uint16_t data_len)
             }
         } while (RL_SUCCESS == status);
 
+        if (RD_SUCCESS == app_ca_uart_ext_decode (dequeue_data, index, &ext_frame))
+        {
+            app_uart_ext_parser (&ext_frame);
+            return;
+        }
+
         memset (&m_uart_payload, 0, sizeof (m_uart_payload));
         err_code = re_ca_uart_decode ((uint8_t *) dequeue_data, &m_uart_payload);
 
@@ -435,12 +1207,25 @@ void app_uart_parser (void * p_data, uint16_t data_len)
             size_t len = index;
             index = 0;
 
-            do
+            // Full ring cannot complete a frame, resync to start of next frame.
+            if (is_overflow)
+            {
+                app_stats_inc (APP_STATS_RX_PARSE_FAIL);
+
+                do
+                {
+                    index++;
+                } while ((index < len) && (RE_CA_UART_STX != dequeue_data[index]));
+            }
+
+            status = RL_SUCCESS;
+
+            while ((RL_SUCCESS == status) && (index < len))
             {
                 status = rl_ringbuffer_queue (&m_uart_ring_buffer, (void *) (dequeue_data + index),
                                               sizeof (uint8_t));
                 index++;
-            } while ((RL_SUCCESS == status) && (index < len));
+            }
         }
     }
 
@@ -496,6 +1281,18 @@ void app_uart_parser (void * p_data, uint16_t data_len)
     }
 }
 
+/** @brief Record latency of advertisement frame which was just sent, if any. */
+static void app_uart_tx_latency_record (void)
+{
+    if (m_tx_flight.is_adv)
+    {
+        const uint32_t now = app_clock_ticks_get();
+        app_latency_record_ticks (APP_LATENCY_STAGE_UART, now - m_tx_flight.stamp.deq_ticks);
+        app_latency_record_ticks (APP_LATENCY_STAGE_TOTAL, now - m_tx_flight.stamp.rx_ticks);
+        m_tx_flight.is_adv = false;
+    }
+}
+
 #ifndef CEEDLING
 static
 #endif
@@ -507,6 +1304,7 @@ rd_status_t app_uart_isr (ri_comm_evt_t evt,
     switch (evt)
     {
         case RI_COMM_SENT:
+            app_uart_tx_latency_record();
             err_code |= ri_scheduler_event_put (NULL, (uint16_t)0, app_uart_on_evt_tx_finish);
             break;
 
@@ -617,14 +1415,17 @@ static re_ca_uart_ble_phy_e re_ca_uart_encode_ble_phy (const uint8_t phy)
     return encoded_phy;
 }
 
-rd_status_t app_uart_send_broadcast (const ri_adv_scan_t * const scan)
+rd_status_t app_uart_send_broadcast (const ri_adv_scan_t * const scan,
+                                     const uint32_t rx_ticks)
 {
+    const app_uart_tx_stamp_t stamp =
+    {
+        .rx_ticks = rx_ticks,
+        .deq_ticks = app_clock_ticks_get()
+    };
     re_ca_uart_payload_t adv = {0};
-    ri_adv_scan_t m_scan = {0};
-    ri_comm_message_t msg = {0};
     rd_status_t err_code = RD_SUCCESS;
     re_status_t re_code = RE_SUCCESS;
-    uint16_t manuf_id;
 
     if (NULL == scan)
     {
@@ -634,8 +1435,6 @@ rd_status_t app_uart_send_broadcast (const ri_adv_scan_t * const scan)
     {
         memcpy (adv.params.adv.mac, scan->addr, sizeof (adv.params.adv.mac));
         memcpy (adv.params.adv.adv, scan->data, scan->data_len);
-        memcpy (m_scan.data, scan->data, scan->data_len);
-        m_scan.data_len = scan->data_len;
         adv.params.adv.rssi_db = scan->rssi;
         adv.params.adv.primary_phy = re_ca_uart_encode_ble_phy (scan->primary_phy);
         adv.params.adv.secondary_phy = re_ca_uart_encode_ble_phy (scan->secondary_phy);
@@ -649,52 +1448,49 @@ rd_status_t app_uart_send_broadcast (const ri_adv_scan_t * const scan)
             : RE_CA_UART_BLE_GAP_POWER_LEVEL_INVALID;
         adv.params.adv.adv_len = scan->data_len;
         adv.cmd = RE_CA_UART_ADV_RPRT2;
-        manuf_id = ri_adv_parse_manuid (m_scan.data, m_scan.data_len);
-        uint16_t filter_id = RB_BLE_MANUFACTURER_ID;
-        bool flag_discard = false;
-
-        if (app_ble_manufacturer_filter_enabled (&filter_id) &&
-                (manuf_id != filter_id))
-        {
-            flag_discard = true;
-        }
 
-        if (flag_discard)
+        // Manufacturer filter has been applied by app_adv_filter in scan ISR.
+        if ((APP_CA_UART_EXT_REPORT_BATCH == m_report_mode)
+                && (g_flag_uart_tx_in_progress || (0U < m_tx_queue.count)))
         {
-            err_code |= RD_ERROR_INVALID_DATA;
-            NRF_LOG_DEBUG ("app_uart_send_broadcast: discard: manufacturer_id=0x%04x: addr=%s: len=%d",
-                           manuf_id,
-                           mac_addr_to_str (scan->addr).buf,
-                           scan->data_len,
-                           scan->primary_phy,
-                           scan->secondary_phy,
-                           scan->ch_index);
+            // More than one report pending, pack into a batch frame.
+            err_code |= app_uart_tx_queue_batch_add (&adv.params.adv, &stamp);
         }
         else
         {
-            _Static_assert (sizeof (msg.data) <= UINT8_MAX, "sizeof (msg) <= UINT8_MAX");
-            msg.data_length = (uint8_t)sizeof (msg.data);
-            re_code = re_ca_uart_encode (msg.data, &msg.data_length, &adv);
-            msg.repeat_count = 1;
-
-            if (RE_SUCCESS == re_code)
-            {
-                NRF_LOG_INFO ("app_uart_send_broadcast: addr=%s: len=%d, primary_phy=%d, secondary_phy=%d, chan=%d, tx_power=%d",
-                              mac_addr_to_str (scan->addr).buf,
-                              scan->data_len,
-                              scan->primary_phy,
-                              scan->secondary_phy,
-                              scan->ch_index,
-                              scan->tx_power);
-                //NRF_LOG_HEXDUMP_INFO (scan->data, scan->data_len);
-                NRF_LOG_INFO ("app_uart_send_broadcast: encoded: len=%d", msg.data_length);
-                NRF_LOG_HEXDUMP_INFO (msg.data, msg.data_length);
-                err_code |= app_uart_send_msg (&msg);
+            // Encode straight into TX queue to avoid a frame-sized copy on stack.
+            ri_comm_message_t * const p_msg = app_uart_tx_queue_reserve (&stamp);
+
+            if (NULL == p_msg)
+            {
+                err_code |= RD_ERROR_NO_MEM;
             }
             else
             {
-                NRF_LOG_ERROR ("%s: re_ca_uart_encode failed", __func__);
-                err_code |= RD_ERROR_INVALID_DATA;
+                _Static_assert (sizeof (p_msg->data) <= UINT8_MAX, "sizeof (msg) <= UINT8_MAX");
+                p_msg->data_length = (uint8_t)sizeof (p_msg->data);
+                re_code = re_ca_uart_encode (p_msg->data, &p_msg->data_length, &adv);
+                p_msg->repeat_count = 1;
+
+                if (RE_SUCCESS == re_code)
+                {
+                    NRF_LOG_INFO ("app_uart_send_broadcast: addr=%s: len=%d, primary_phy=%d, secondary_phy=%d, chan=%d, tx_power=%d",
+                                  mac_addr_to_str (scan->addr).buf,
+                                  scan->data_len,
+                                  scan->primary_phy,
+                                  scan->secondary_phy,
+                                  scan->ch_index,
+                                  scan->tx_power);
+                    NRF_LOG_INFO ("app_uart_send_broadcast: encoded: len=%d", p_msg->data_length);
+                    NRF_LOG_HEXDUMP_INFO (p_msg->data, p_msg->data_length);
+                    err_code |= app_uart_tx_queue_commit();
+                }
+                else
+                {
+                    NRF_LOG_ERROR ("%s: re_ca_uart_encode failed", __func__);
+                    app_stats_inc (APP_STATS_ENCODE_FAIL);
+                    err_code |= RD_ERROR_INVALID_DATA;
+                }
             }
         }
     }
@@ -723,7 +1519,7 @@ rd_status_t app_uart_poll_configuration (void)
 
     if (RE_SUCCESS == re_code)
     {
-        err_code |= app_uart_send_msg (&msg);
+        err_code |= app_uart_send_msg (&msg, NULL);
 
         if (RD_SUCCESS != err_code)
         {
@@ -26,6 +26,8 @@ bool app_uart_ringbuffer_lock_dummy (volatile uint32_t * const flag, bool lock);
 void app_uart_parser (void * p_data, uint16_t data_len);
 void app_uart_on_evt_send_device_id (void * p_data, uint16_t data_len);
 void app_uart_on_evt_send_ack (void * p_data, uint16_t data_len);
+void app_uart_on_evt_send_ext_ack (void * p_data, uint16_t data_len);
+void app_uart_on_evt_send_ext_reply (void * p_data, uint16_t data_len);
 void app_uart_on_evt_tx_finish (void * p_data, uint16_t data_len);
 #if 0
 void app_uart_repeat_send (void * p_data, uint16_t data_len);
@@ -57,13 +59,38 @@ rd_status_t app_uart_init (void);
  * The format is defined by ruuvi.endpoints.c/
  *
  * @param[in] scan Scan result from BLE advertisement module.
+ * @param[in] rx_ticks Time scan was received, app_clock RTC ticks. Forwarding
+ *                     latency is recorded in app_latency when frame has been sent.
  * @retval RD_SUCCESS If encoding and queuing data to UART was successful.
  * @retval RD_ERROR_NULL If scan was NULL.
  * @retval RD_ERROR_INVALID_DATA If scan cannot be encoded for any reason.
  * @retval RD_ERROR_DATA_SIZE If scan had larger advertisement size than allowed by
  *                            encoding module.
+ * @retval RD_ERROR_NO_MEM If UART was busy and TX queue was full, frame was dropped.
  */
-rd_status_t app_uart_send_broadcast (const ri_adv_scan_t * const scan);
+rd_status_t app_uart_send_broadcast (const ri_adv_scan_t * const scan,
+                                     const uint32_t rx_ticks);
+
+/**
+ * @brief Get number of advertisement frames dropped by TX queue.
+ *
+ * Frames are queued while UART is busy and sent from TX complete event.
+ * A frame is dropped if queue is full or if driver refuses it, see app_stats.
+ *
+ * @return Number of dropped frames since boot or RESET_STATS.
+ */
+uint32_t app_uart_tx_drops_get (void);
+
+/**
+ * @brief Check if TX queue can take no more advertisements.
+ *
+ * Advertisements sent while queue is full are dropped, caller can keep them
+ * until TX complete event makes room.
+ *
+ * @return True if queue is full and has no open batch with room for a
+ *         full-size advertisement.
+ */
+bool app_uart_tx_queue_is_full (void);
 
 /**
  * @brief Poll scanning configuration through UART.
@@ -151,9 +151,14 @@
 #   define RI_SCHEDULER_ENABLED (1U)
 #endif
 
-/** @brief Maximum number of tasks in scheduler. */
+/**
+ * @brief Maximum number of tasks in scheduler.
+ *
+ * Advertisements are queued in app_adv_pool, scheduler carries only UART
+ * control events, which main loop runs before advertisements.
+ */
 #ifndef RI_SCHEDULER_LENGTH
-#   define RI_SCHEDULER_LENGTH (10U)
+#   define RI_SCHEDULER_LENGTH (6U)
 #endif
 
 /**
@@ -165,6 +170,252 @@
 #  define RI_SCHEDULER_SIZE (256U)
 #endif
 
+/**
+ * @brief Capacity profile of target MCU.
+ *
+ * Defaults of pool, TX queue, tag table and MAC list scale with the RAM of the
+ * part. nRF52832 and nRF52840 spend their extra RAM on riding out longer UART
+ * stalls and tracking more tags. nRF52811 has under 13 KiB of RAM after the
+ * SoftDevice, 4 KiB of which is heap and stack. Its profile together with match
+ * programs, latency histograms and scan schedule takes about 3.8 KiB of static
+ * RAM, 1 KiB of it offset by the scheduler slots advertisements no longer use,
+ * so its MAC list is kept short.
+ * Linker script of each target checks that static data, heap and stack leave a
+ * margin free in the RAM region.
+ */
+#if defined (NRF52840_XXAA)
+#   define APP_PROFILE_UART_TX_QUEUE_LEN (32U)
+#   define APP_PROFILE_TAG_TABLE_LEN     (192U)
+#   define APP_PROFILE_MAC_LIST_LEN      (8192U)
+#   define APP_PROFILE_ADV_POOL_SIZE     (32768U)
+#   define APP_PROFILE_ADV_POOL_BUCKETS  (16U)
+#elif defined (NRF52832_XXAA)
+#   define APP_PROFILE_UART_TX_QUEUE_LEN (16U)
+#   define APP_PROFILE_TAG_TABLE_LEN     (128U)
+#   define APP_PROFILE_MAC_LIST_LEN      (2048U)
+#   define APP_PROFILE_ADV_POOL_SIZE     (8192U)
+#   define APP_PROFILE_ADV_POOL_BUCKETS  (8U)
+#else
+#   define APP_PROFILE_UART_TX_QUEUE_LEN (4U)
+#   define APP_PROFILE_TAG_TABLE_LEN     (32U)
+#   define APP_PROFILE_MAC_LIST_LEN      (64U)
+#   define APP_PROFILE_ADV_POOL_SIZE     (1024U)
+#   define APP_PROFILE_ADV_POOL_BUCKETS  (4U)
+#endif
+
+/**
+ * @brief Number of encoded advertisement frames buffered while UART is busy.
+ *
+ * Each slot reserves one ri_comm_message_t of RAM.
+ */
+#ifndef APP_UART_TX_QUEUE_LEN
+#   define APP_UART_TX_QUEUE_LEN APP_PROFILE_UART_TX_QUEUE_LEN
+#endif
+
+/**
+ * @brief Resolution of application millisecond clock.
+ *
+ * Clock runs on a repeated timer, shorter tick wakes CPU more often.
+ */
+#ifndef APP_CLOCK_TICK_MS
+#   define APP_CLOCK_TICK_MS (100U)
+#endif
+
+/** @brief CPU clock in MHz, converts cycle counter to microseconds. */
+#ifndef APP_CLOCK_CYCLES_PER_US
+#   define APP_CLOCK_CYCLES_PER_US (64U)
+#endif
+
+/** @brief Frequency of app_timer RTC counter, must match app_timer configuration. */
+#ifndef APP_CLOCK_RTC_TICKS_PER_S
+#   define APP_CLOCK_RTC_TICKS_PER_S (32768U)
+#endif
+
+/**
+ * @brief Number of tags tracked for duplicate suppression.
+ *
+ * Least recently seen tag is evicted when table is full.
+ */
+#ifndef APP_TAG_TABLE_LEN
+#   define APP_TAG_TABLE_LEN APP_PROFILE_TAG_TABLE_LEN
+#endif
+
+/**
+ * @brief Longest per-tag rate limit interval.
+ *
+ * Watchdog is fed only by forwarded advertisements. With only a few tags in
+ * range a longer interval would let it expire, half of the watchdog interval
+ * leaves room for the advertising interval of tags.
+ */
+#ifndef APP_ADV_FILTER_RATE_LIMIT_MAX_MS
+#   define APP_ADV_FILTER_RATE_LIMIT_MAX_MS (APP_WDT_INTERVAL_MS / 2U)
+#endif
+
+/**
+ * @brief Number of tag MAC addresses in allow/deny list.
+ *
+ * List is double buffered, each entry takes 8 bytes of RAM.
+ */
+#ifndef APP_MAC_LIST_LEN
+#   define APP_MAC_LIST_LEN APP_PROFILE_MAC_LIST_LEN
+#endif
+
+/**
+ * @brief Bytes in advertisement match program, 4 per instruction.
+ *
+ * Program is double buffered, RAM use is twice this.
+ */
+#ifndef APP_ADV_MATCH_PROGRAM_MAX
+#   define APP_ADV_MATCH_PROGRAM_MAX (64U)
+#endif
+
+/**
+ * @brief Bytes in advertisement pool, power of two.
+ *
+ * Record takes 24 bytes of header and data rounded up to 4 bytes, i.e. 56 bytes
+ * for a legacy advertisement. nRF52811 default takes the RAM of the 4 scheduler
+ * slots advertisements used to take.
+ */
+#ifndef APP_ADV_POOL_SIZE
+#   define APP_ADV_POOL_SIZE APP_PROFILE_ADV_POOL_SIZE
+#endif
+
+/**
+ * @brief Number of MAC hash buckets advertisement pool is split into, power of two.
+ *
+ * Each bucket gets an equal share of APP_ADV_POOL_SIZE and of forwarding
+ * bandwidth, so a chatty device affects only tags which share its bucket.
+ */
+#ifndef APP_ADV_POOL_BUCKETS
+#   define APP_ADV_POOL_BUCKETS APP_PROFILE_ADV_POOL_BUCKETS
+#endif
+
+/**
+ * @brief Scan coded and 1M primary PHYs in one session.
+ *
+ * S140 SoftDevice supports this on boards with coded PHY. Session requests both
+ * 1M and coded PHY in rt_adv_init_t even if only 2M PHY is enabled next to
+ * coded PHY, driver scans every primary PHY requested there.
+ */
+#ifndef APP_BLE_CONCURRENT_PHY_SUPPORTED
+#   define APP_BLE_CONCURRENT_PHY_SUPPORTED RB_BLE_CODED_SUPPORTED
+#endif
+
+/**
+ * @brief Lowest share of alternating scan windows on coded PHY, in percent.
+ *
+ * Windows are split between coded and 1M PHY by advertisements received per
+ * window on each, within these bounds. 100 - APP_BLE_CODED_SHARE_MAX_PERCENT
+ * is guaranteed to 1M PHY.
+ */
+#ifndef APP_BLE_CODED_SHARE_MIN_PERCENT
+#   define APP_BLE_CODED_SHARE_MIN_PERCENT (10U)
+#endif
+
+/** @brief Highest share of alternating scan windows on coded PHY, in percent. */
+#ifndef APP_BLE_CODED_SHARE_MAX_PERCENT
+#   define APP_BLE_CODED_SHARE_MAX_PERCENT (90U)
+#endif
+
+/**
+ * @brief Lowest weight of an enabled channel in adaptive channel dwell, in percent.
+ *
+ * Keeps yield of quiet channels measured. Enabled channels share windows in
+ * proportion to their weights.
+ */
+#ifndef APP_BLE_CHANNEL_SHARE_MIN_PERCENT
+#   define APP_BLE_CHANNEL_SHARE_MIN_PERCENT (10U)
+#endif
+
+/** @brief Highest weight of an enabled channel in adaptive channel dwell, in percent. */
+#ifndef APP_BLE_CHANNEL_SHARE_MAX_PERCENT
+#   define APP_BLE_CHANNEL_SHARE_MAX_PERCENT (80U)
+#endif
+
+/** @brief Shortest scan window and interval, BLE limit 2.5 ms rounded up. */
+#ifndef APP_BLE_SCAN_INTERVAL_MIN_MS
+#   define APP_BLE_SCAN_INTERVAL_MIN_MS (3U)
+#endif
+
+/** @brief Longest scan interval, BLE limit 10.24 s. */
+#ifndef APP_BLE_SCAN_INTERVAL_MAX_MS
+#   define APP_BLE_SCAN_INTERVAL_MAX_MS (10240U)
+#endif
+
+/**
+ * @brief Shortest scan window timeout set by host.
+ *
+ * Each timeout costs a re-arm or radio restart.
+ */
+#ifndef APP_BLE_SCAN_TIMEOUT_MIN_MS
+#   define APP_BLE_SCAN_TIMEOUT_MIN_MS (100U)
+#endif
+
+/** @brief Number of entries in scan schedule uploaded by host. */
+#ifndef APP_SCAN_SCHEDULE_LEN
+#   define APP_SCAN_SCHEDULE_LEN (8U)
+#endif
+
+/**
+ * @brief Shortest scan schedule window.
+ *
+ * Each window costs a radio restart if PHY or channels change.
+ */
+#ifndef APP_SCAN_SCHEDULE_WINDOW_MIN_MS
+#   define APP_SCAN_SCHEDULE_WINDOW_MIN_MS (100U)
+#endif
+
+/**
+ * @brief Advertisements forwarded per main loop pass.
+ *
+ * Scheduler runs between passes, so UART commands and ACKs wait for at most
+ * this many advertisements.
+ */
+#ifndef APP_BLE_ADV_FORWARD_BUDGET
+#   define APP_BLE_ADV_FORWARD_BUDGET (4U)
+#endif
+
+/**
+ * @brief Advertisement pool fill, in percent, at which repeated payloads are shed.
+ *
+ * A tag's payload is dropped if it is the one last forwarded for that tag.
+ */
+#ifndef APP_ADV_SHED_REPEAT_PERCENT
+#   define APP_ADV_SHED_REPEAT_PERCENT (50U)
+#endif
+
+/**
+ * @brief Advertisement pool fill, in percent, at which weak advertisements are shed.
+ */
+#ifndef APP_ADV_SHED_WEAK_PERCENT
+#   define APP_ADV_SHED_WEAK_PERCENT (75U)
+#endif
+
+/**
+ * @brief Advertisements below this RSSI are shed at APP_ADV_SHED_WEAK_PERCENT.
+ */
+#ifndef APP_ADV_SHED_RSSI_DBM
+#   define APP_ADV_SHED_RSSI_DBM (-80)
+#endif
+
+/**
+ * @brief Advertisement pool fill, in percent, at which scan stays on one PHY.
+ *
+ * Checked at the end of each scan window against the highest fill of the window.
+ */
+#ifndef APP_ADV_SHED_NARROW_PERCENT
+#   define APP_ADV_SHED_NARROW_PERCENT (90U)
+#endif
+
+/**
+ * @brief Number of log2 microsecond buckets in each forwarding latency histogram.
+ *
+ * Last bucket collects everything above 2^(APP_LATENCY_BUCKETS - 1) us.
+ */
+#ifndef APP_LATENCY_BUCKETS
+#   define APP_LATENCY_BUCKETS (20U)
+#endif
+
 
 /**
  * @brief Enable Ruuvi Timer interface.
@@ -23,6 +23,7 @@
 #include "ruuvi_endpoint_ca_uart.h"
 #include "main.h"
 #include "app_ble.h"
+#include "app_clock.h"
 #include "app_uart.h"
 #if !defined(CEEDLING) && !defined(SONAR)
 #include "nrf_log.h"
@@ -94,6 +95,7 @@ static void setup (void)
     err_code |= leds_init();
     // Requires timers
     err_code |= ri_yield_low_power_enable (true);
+    err_code |= app_clock_init();
     // Requires LEDs
     err_code |= app_uart_init();
 #if defined(RUUVI_GW_NRF_POLL_CONFIG_DISABLED) && RUUVI_GW_NRF_POLL_CONFIG_DISABLED
@@ -126,8 +128,13 @@ int main (void)
 
     do
     {
+        // UART control events first, then a bounded batch of advertisements.
         ri_scheduler_execute();
-        ri_yield();
+
+        if (!app_ble_adv_forward())
+        {
+            ri_yield();
+        }
     } while (LOOP_FOREVER);
 
     return -1; // Unreachable code unless running unit tests.
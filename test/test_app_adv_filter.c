@@ -0,0 +1,517 @@
+#include "unity.h"
+
+#include "app_adv_filter.h"
+#include "app_adv_match.h"
+#include "app_adv_pool.h"
+#include "app_config.h"
+#include "app_mac_list.h"
+#include "app_tag_table.h"
+#include "mock_app_clock.h"
+#include "ruuvi_boards.h"
+#include "ruuvi_endpoint_ca_uart.h"
+#include "mock_ruuvi_interface_communication_ble_advertising.h"
+#include <string.h>
+
+static ri_adv_scan_t mock_scan =
+{
+    .addr = {0xFA, 0xEB, 0xDC, 0xCD, 0xBE, 0xAF},
+    .rssi = -50,
+    .data = {0x02, 0x01, 0x06, 0x03, 0xFF, 0x99, 0x04},
+    .data_len = 7,
+};
+
+void setUp (void)
+{
+    app_adv_filter_manufacturer_set (true, RB_BLE_MANUFACTURER_ID);
+    app_adv_filter_manufacturer_extra_set (NULL, 0, false);
+    app_adv_filter_dedup_window_set (0);
+    app_adv_filter_rate_limit_set (0);
+    app_adv_filter_rssi_floor_set (INT8_MIN, 0);
+    app_adv_filter_rejects_reset();
+    app_tag_table_clear();
+    app_mac_list_clear();
+    (void) app_mac_list_mode_set (APP_MAC_LIST_MODE_OFF);
+    app_mac_list_clear();
+    app_adv_match_program_set (NULL, 0);
+    app_adv_pool_init();
+    (void) app_adv_filter_shed_peak_take();
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_adv_filter_check_accept (void)
+{
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (0, app_adv_filter_rejects_get (
+                           APP_ADV_FILTER_REJECT_MANUFACTURER));
+}
+
+void test_app_adv_filter_check_manufacturer_mismatch (void)
+{
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x004C);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MANUFACTURER,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (
+                           APP_ADV_FILTER_REJECT_MANUFACTURER));
+}
+
+void test_app_adv_filter_check_filter_disabled_skips_parse (void)
+{
+    app_adv_filter_manufacturer_set (false, RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_check_new_id (void)
+{
+    app_adv_filter_manufacturer_set (true, 0x004C);
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x004C);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_check_invalid (void)
+{
+    ri_adv_scan_t long_scan = mock_scan;
+    long_scan.data_len = RE_CA_UART_ADV_BYTES + 1U;
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_INVALID, app_adv_filter_check (NULL,
+                       sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_INVALID, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan) - 1U));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_INVALID, app_adv_filter_check (&long_scan,
+                       sizeof (long_scan)));
+    TEST_ASSERT_EQUAL (3, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_INVALID));
+}
+
+void test_app_adv_filter_reject_counts_by_reason (void)
+{
+    app_adv_filter_reject (APP_ADV_FILTER_REJECT_QUEUE_FULL);
+    app_adv_filter_reject (APP_ADV_FILTER_REJECT_QUEUE_FULL);
+    app_adv_filter_reject (APP_ADV_FILTER_ACCEPT);
+    app_adv_filter_reject (APP_ADV_FILTER_REASON_NUM);
+    TEST_ASSERT_EQUAL (2, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_QUEUE_FULL));
+    TEST_ASSERT_EQUAL (0, app_adv_filter_rejects_get (
+                           APP_ADV_FILTER_REJECT_MANUFACTURER));
+    TEST_ASSERT_EQUAL (0, app_adv_filter_rejects_get (APP_ADV_FILTER_ACCEPT));
+    TEST_ASSERT_EQUAL (0, app_adv_filter_rejects_get (APP_ADV_FILTER_REASON_NUM));
+    app_adv_filter_rejects_reset();
+    TEST_ASSERT_EQUAL (0, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_QUEUE_FULL));
+}
+
+static app_adv_filter_reason_t check_uncommitted_at (const ri_adv_scan_t * const p_scan,
+        const uint32_t now_ms)
+{
+    ri_adv_parse_manuid_ExpectAndReturn ((uint8_t *) p_scan->data, p_scan->data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    app_clock_ms_get_ExpectAndReturn (now_ms);
+    return app_adv_filter_check (p_scan, sizeof (*p_scan));
+}
+
+/** @brief Check advertisement, accepted advertisement is stored like scan ISR does. */
+static app_adv_filter_reason_t check_at (const ri_adv_scan_t * const p_scan,
+                                         const uint32_t now_ms)
+{
+    const app_adv_filter_reason_t reason = check_uncommitted_at (p_scan, now_ms);
+
+    if (APP_ADV_FILTER_ACCEPT == reason)
+    {
+        app_adv_filter_commit();
+    }
+
+    return reason;
+}
+
+void test_app_adv_filter_dedup_drops_repeat_within_window (void)
+{
+    app_adv_filter_dedup_window_set (500);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&mock_scan, 1400));
+    TEST_ASSERT_EQUAL (2, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_DUPLICATE));
+}
+
+void test_app_adv_filter_dedup_forwards_after_window (void)
+{
+    app_adv_filter_dedup_window_set (500);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1500));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&mock_scan, 1600));
+}
+
+void test_app_adv_filter_dedup_forwards_new_payload (void)
+{
+    ri_adv_scan_t next = mock_scan;
+    next.data[6] = 0x05;
+    app_adv_filter_dedup_window_set (500);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&next, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&next, 1000));
+}
+
+void test_app_adv_filter_dedup_uncommitted_forwards_repeat (void)
+{
+    app_adv_filter_dedup_window_set (500);
+    // Accepted but not stored, e.g. pool was full.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_uncommitted_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&mock_scan, 1100));
+}
+
+void test_app_adv_filter_commit_without_accept_does_nothing (void)
+{
+    app_adv_filter_dedup_window_set (500);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE,
+                       check_uncommitted_at (&mock_scan, 1100));
+    // Commit after a rejection must not refresh the forwarded time.
+    app_adv_filter_commit();
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1500));
+}
+
+void test_app_adv_filter_dedup_per_tag (void)
+{
+    ri_adv_scan_t other = mock_scan;
+    other.addr[0] = 0x01;
+    app_adv_filter_dedup_window_set (500);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&other, 1000));
+    TEST_ASSERT_EQUAL (2, app_tag_table_count());
+}
+
+void test_app_adv_filter_dedup_disabled_keeps_table_empty (void)
+{
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (0, app_tag_table_count());
+}
+
+void test_app_adv_filter_rate_limit_per_tag (void)
+{
+    ri_adv_scan_t next = mock_scan;
+    ri_adv_scan_t other = mock_scan;
+    next.data[6] = 0x05;
+    other.addr[0] = 0x01;
+    app_adv_filter_rate_limit_set (2000);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    // New payload of the same tag is limited, other tags are not.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RATE_LIMIT, check_at (&next, 1500));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&other, 1500));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&next, 3000));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_RATE_LIMIT));
+}
+
+void test_app_adv_filter_rate_limit_uncommitted_forwards_next (void)
+{
+    ri_adv_scan_t next = mock_scan;
+    next.data[6] = 0x05;
+    app_adv_filter_rate_limit_set (2000);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    // Accepted after the interval but not stored, interval is not restarted.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_uncommitted_at (&next, 3000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&next, 3100));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RATE_LIMIT, check_at (&mock_scan, 3200));
+}
+
+void test_app_adv_filter_rate_limit_below_watchdog (void)
+{
+    ri_adv_scan_t next = mock_scan;
+    next.data[6] = 0x05;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_filter_rate_limit_set (2000));
+    // A tag forwarded once per interval must keep watchdog fed.
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_adv_filter_rate_limit_set (APP_ADV_FILTER_RATE_LIMIT_MAX_MS + 1U));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_adv_filter_rate_limit_set (UINT16_MAX));
+    TEST_ASSERT_LESS_THAN (APP_WDT_INTERVAL_MS, APP_ADV_FILTER_RATE_LIMIT_MAX_MS);
+    // Previous interval stays.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RATE_LIMIT, check_at (&next, 2500));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&next, 3000));
+    TEST_ASSERT_EQUAL (RD_SUCCESS,
+                       app_adv_filter_rate_limit_set (APP_ADV_FILTER_RATE_LIMIT_MAX_MS));
+}
+
+void test_app_adv_filter_rate_limit_counts_duplicates_first (void)
+{
+    app_adv_filter_dedup_window_set (500);
+    app_adv_filter_rate_limit_set (2000);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&mock_scan, 1100));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RATE_LIMIT, check_at (&mock_scan, 1600));
+}
+
+static app_adv_filter_reason_t check_rssi_at (const int8_t rssi, const uint32_t now_ms)
+{
+    ri_adv_scan_t scan = mock_scan;
+    scan.rssi = rssi;
+    return check_at (&scan, now_ms);
+}
+
+void test_app_adv_filter_rssi_floor_drops_before_parse (void)
+{
+    ri_adv_scan_t weak = mock_scan;
+    weak.rssi = -91;
+    app_adv_filter_rssi_floor_set (-90, 0);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RSSI, app_adv_filter_check (&weak,
+                       sizeof (weak)));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_RSSI));
+    TEST_ASSERT_EQUAL (0, app_tag_table_count());
+    weak.rssi = -90;
+    ri_adv_parse_manuid_ExpectAndReturn (weak.data, weak.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&weak,
+                       sizeof (weak)));
+}
+
+void test_app_adv_filter_rssi_hysteresis (void)
+{
+    ri_adv_scan_t weak = mock_scan;
+    app_adv_filter_rssi_floor_set (-80, 6);
+    // Tag in hysteresis band has not entered range yet.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RSSI, check_rssi_at (-83, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_rssi_at (-80, 1100));
+    // Tag in range stays in range within the band.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_rssi_at (-86, 1200));
+    // Below band is rejected without looking up the tag.
+    weak.rssi = -87;
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RSSI, app_adv_filter_check (&weak,
+                       sizeof (weak)));
+    // Tag which left range must reach floor again.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_RSSI, check_rssi_at (-81, 1400));
+}
+
+void test_app_adv_filter_mac_list_allow_drops_unlisted_before_parse (void)
+{
+    const uint8_t other[APP_MAC_LIST_MAC_LEN] = {0xFA, 0xEB, 0xDC, 0xCD, 0xBE, 0x01};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (other, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MAC_LIST,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_MAC_LIST));
+    app_mac_list_clear();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mock_scan.addr, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_mac_list_deny_drops_listed (void)
+{
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mock_scan.addr, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_DENY));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MAC_LIST,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_manufacturer_extra_ids (void)
+{
+    const uint16_t ids[] = {0x004C, 0x0059, 0x0006};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_filter_manufacturer_extra_set (ids, 3, false));
+
+    for (size_t ii = 0; ii < (sizeof (ids) / sizeof (ids[0])); ii++)
+    {
+        ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, ids[ii]);
+        TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                           sizeof (mock_scan)));
+    }
+
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x0075);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MANUFACTURER,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_manufacturer_id_all_ones (void)
+{
+    const uint16_t ids[] = {0xFFFF};
+    app_adv_filter_manufacturer_set (true, 0xFFFF);
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0xFFFF);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+    app_adv_filter_manufacturer_set (true, RB_BLE_MANUFACTURER_ID);
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0xFFFF);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MANUFACTURER,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_filter_manufacturer_extra_set (ids, 1, false));
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0xFFFF);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_manufacturer_id_zero (void)
+{
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x0000);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MANUFACTURER,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+    app_adv_filter_manufacturer_set (true, 0x0000);
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x0000);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_manufacturer_extra_ids_kept_on_id_change (void)
+{
+    const uint16_t ids[] = {0x004C};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_filter_manufacturer_extra_set (ids, 1, false));
+    app_adv_filter_manufacturer_set (true, 0x0059);
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x004C);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MANUFACTURER,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_manufacturer_accept_none (void)
+{
+    ri_adv_scan_t flags_only = mock_scan;
+    flags_only.data_len = 3;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_filter_manufacturer_extra_set (NULL, 0, true));
+    ri_adv_parse_manuid_ExpectAndReturn (flags_only.data, flags_only.data_len, 0);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&flags_only,
+                       sizeof (flags_only)));
+    // Advertisement of another manufacturer is still rejected.
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len, 0x004C);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MANUFACTURER,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_manufacturer_extra_set_invalid (void)
+{
+    const uint16_t ids[APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX + 1U] = {0};
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_adv_filter_manufacturer_extra_set (NULL, 1, false));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_adv_filter_manufacturer_extra_set (ids,
+                               APP_ADV_FILTER_MANUFACTURER_EXTRA_MAX + 1U, false));
+}
+
+void test_app_adv_filter_match_program (void)
+{
+    // Manufacturer data with data format byte 0x05.
+    const uint8_t program[] =
+    {
+        APP_ADV_MATCH_OP_AD_TYPE, 0xFF, 0, 0,
+        APP_ADV_MATCH_OP_BYTE, 2, 0x05, 0xFF
+    };
+    ri_adv_scan_t df5 = mock_scan;
+    const uint8_t data[] = {0x02, 0x01, 0x06, 0x04, 0xFF, 0x99, 0x04, 0x05};
+    memcpy (df5.data, data, sizeof (data));
+    df5.data_len = sizeof (data);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (program, sizeof (program)));
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_MATCH,
+                       app_adv_filter_check (&mock_scan, sizeof (mock_scan)));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_MATCH));
+    ri_adv_parse_manuid_ExpectAndReturn (df5.data, df5.data_len, RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&df5, sizeof (df5)));
+}
+
+/**
+ * @brief Fill pool with short advertisements of one tag up to given percentage.
+ *
+ * A single chatty advertiser fills only its own bucket, which must be enough
+ * to start shedding.
+ */
+static void pool_fill (const uint32_t percent)
+{
+    const app_clock_stamp_t rx = {0};
+
+    while (app_adv_pool_fill_get() < percent)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&mock_scan, &rx));
+    }
+}
+
+void test_app_adv_filter_shed_level_follows_pool (void)
+{
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_NONE, app_adv_filter_shed_level_get());
+    pool_fill (APP_ADV_SHED_REPEAT_PERCENT);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_REPEAT, app_adv_filter_shed_level_get());
+    pool_fill (APP_ADV_SHED_WEAK_PERCENT);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_WEAK, app_adv_filter_shed_level_get());
+    pool_fill (APP_ADV_SHED_NARROW_PERCENT);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_NARROW, app_adv_filter_shed_level_get());
+    app_adv_pool_init();
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_NONE, app_adv_filter_shed_level_get());
+}
+
+void test_app_adv_filter_shed_none_forwards_repeats (void)
+{
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+    ri_adv_parse_manuid_ExpectAndReturn (mock_scan.data, mock_scan.data_len,
+                                         RB_BLE_MANUFACTURER_ID);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, app_adv_filter_check (&mock_scan,
+                       sizeof (mock_scan)));
+}
+
+void test_app_adv_filter_shed_repeat_drops_forwarded_payload (void)
+{
+    ri_adv_scan_t next = mock_scan;
+    next.data[6] = 0x05;
+    pool_fill (APP_ADV_SHED_REPEAT_PERCENT);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    // Repeat is dropped however old, dedup window is not involved.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_SHED_REPEAT, check_at (&mock_scan, 60000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&next, 60000));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_SHED_REPEAT));
+    TEST_ASSERT_EQUAL (0, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_DUPLICATE));
+}
+
+void test_app_adv_filter_shed_repeat_dedup_window_counts_first (void)
+{
+    app_adv_filter_dedup_window_set (500);
+    pool_fill (APP_ADV_SHED_REPEAT_PERCENT);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&mock_scan, 1000));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_DUPLICATE, check_at (&mock_scan, 1100));
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_SHED_REPEAT, check_at (&mock_scan, 2000));
+}
+
+void test_app_adv_filter_shed_weak_drops_low_rssi (void)
+{
+    ri_adv_scan_t weak = mock_scan;
+    pool_fill (APP_ADV_SHED_WEAK_PERCENT);
+    weak.rssi = APP_ADV_SHED_RSSI_DBM - 1;
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_SHED_RSSI,
+                       app_adv_filter_check (&weak, sizeof (weak)));
+    weak.rssi = APP_ADV_SHED_RSSI_DBM;
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&weak, 1000));
+    TEST_ASSERT_EQUAL (1, app_adv_filter_rejects_get (APP_ADV_FILTER_REJECT_SHED_RSSI));
+}
+
+void test_app_adv_filter_shed_repeat_keeps_weak (void)
+{
+    ri_adv_scan_t weak = mock_scan;
+    weak.rssi = APP_ADV_SHED_RSSI_DBM - 1;
+    pool_fill (APP_ADV_SHED_REPEAT_PERCENT);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_ACCEPT, check_at (&weak, 1000));
+}
+
+void test_app_adv_filter_shed_peak_take (void)
+{
+    ri_adv_scan_t weak = mock_scan;
+    weak.rssi = APP_ADV_SHED_RSSI_DBM - 1;
+    pool_fill (APP_ADV_SHED_NARROW_PERCENT);
+    // Pool level alone is not a peak, peak is what filter applied.
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_NONE, app_adv_filter_shed_peak_take());
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REJECT_SHED_RSSI,
+                       app_adv_filter_check (&weak, sizeof (weak)));
+    app_adv_pool_init();
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_NARROW, app_adv_filter_shed_peak_take());
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_NONE, app_adv_filter_shed_peak_take());
+}
@@ -0,0 +1,118 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_adv_match.h"
+#include <string.h>
+
+// Flags, Ruuvi manufacturer data of format 5 truncated to 3 bytes.
+static const uint8_t mock_df5[] = {0x02, 0x01, 0x06, 0x04, 0xFF, 0x99, 0x04, 0x05};
+// Flags, Ruuvi manufacturer data of format E1 truncated to 3 bytes.
+static const uint8_t mock_dfe1[] = {0x02, 0x01, 0x06, 0x04, 0xFF, 0x99, 0x04, 0xE1};
+// Flags only.
+static const uint8_t mock_flags[] = {0x02, 0x01, 0x06};
+
+static const uint8_t mock_program_df5_or_e1[] =
+{
+    APP_ADV_MATCH_OP_AD_TYPE, 0xFF, 0, 0,
+    APP_ADV_MATCH_OP_BYTE, 2, 0x05, 0xFF,
+    APP_ADV_MATCH_OP_OR, 0, 0, 0,
+    APP_ADV_MATCH_OP_AD_TYPE, 0xFF, 0, 0,
+    APP_ADV_MATCH_OP_BYTE, 2, 0xE1, 0xFF
+};
+
+void setUp (void)
+{
+    app_adv_match_program_set (NULL, 0);
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_adv_match_empty_program_matches_all (void)
+{
+    TEST_ASSERT_TRUE (app_adv_match_check (mock_flags, sizeof (mock_flags)));
+    TEST_ASSERT_TRUE (app_adv_match_check (NULL, 0));
+}
+
+void test_app_adv_match_rules_or (void)
+{
+    uint8_t other[sizeof (mock_df5)];
+    memcpy (other, mock_df5, sizeof (other));
+    other[sizeof (other) - 1U] = 0x03;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (mock_program_df5_or_e1,
+                       sizeof (mock_program_df5_or_e1)));
+    TEST_ASSERT_TRUE (app_adv_match_check (mock_df5, sizeof (mock_df5)));
+    TEST_ASSERT_TRUE (app_adv_match_check (mock_dfe1, sizeof (mock_dfe1)));
+    TEST_ASSERT_FALSE (app_adv_match_check (other, sizeof (other)));
+    TEST_ASSERT_FALSE (app_adv_match_check (mock_flags, sizeof (mock_flags)));
+}
+
+void test_app_adv_match_byte_mask (void)
+{
+    const uint8_t program[] = {APP_ADV_MATCH_OP_BYTE, 2, 0x04, 0x0C};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (program, sizeof (program)));
+    TEST_ASSERT_TRUE (app_adv_match_check (mock_flags, sizeof (mock_flags)));
+}
+
+void test_app_adv_match_byte_past_ad_fails (void)
+{
+    const uint8_t program[] =
+    {
+        APP_ADV_MATCH_OP_AD_TYPE, 0x01, 0, 0,
+        APP_ADV_MATCH_OP_BYTE, 1, 0x04, 0xFF
+    };
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (program, sizeof (program)));
+    TEST_ASSERT_FALSE (app_adv_match_check (mock_df5, sizeof (mock_df5)));
+}
+
+void test_app_adv_match_len_range (void)
+{
+    const uint8_t program[] = {APP_ADV_MATCH_OP_LEN, 4, 8, 0};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (program, sizeof (program)));
+    TEST_ASSERT_TRUE (app_adv_match_check (mock_df5, sizeof (mock_df5)));
+    TEST_ASSERT_FALSE (app_adv_match_check (mock_flags, sizeof (mock_flags)));
+}
+
+void test_app_adv_match_truncated_ad_not_found (void)
+{
+    const uint8_t program[] = {APP_ADV_MATCH_OP_AD_TYPE, 0xFF, 0, 0};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (program, sizeof (program)));
+    TEST_ASSERT_FALSE (app_adv_match_check (mock_df5, sizeof (mock_df5) - 1U));
+}
+
+void test_app_adv_match_program_set_invalid (void)
+{
+    const uint8_t unknown[] = {APP_ADV_MATCH_OP_NUM, 0, 0, 0};
+    const uint8_t leading_or[] =
+    {
+        APP_ADV_MATCH_OP_OR, 0, 0, 0,
+        APP_ADV_MATCH_OP_LEN, 0, 31, 0
+    };
+    const uint8_t trailing_or[] =
+    {
+        APP_ADV_MATCH_OP_LEN, 0, 31, 0,
+        APP_ADV_MATCH_OP_OR, 0, 0, 0
+    };
+    const uint8_t too_long[APP_ADV_MATCH_PROGRAM_MAX + APP_ADV_MATCH_INSTR_LEN] = {0};
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_adv_match_program_set (NULL, 4));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_adv_match_program_set (unknown, 3));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_adv_match_program_set (unknown,
+                       sizeof (unknown)));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_adv_match_program_set (leading_or,
+                       sizeof (leading_or)));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_adv_match_program_set (trailing_or,
+                       sizeof (trailing_or)));
+    TEST_ASSERT_EQUAL (RD_ERROR_DATA_SIZE, app_adv_match_program_set (too_long,
+                       sizeof (too_long)));
+}
+
+void test_app_adv_match_invalid_program_keeps_previous (void)
+{
+    const uint8_t unknown[] = {APP_ADV_MATCH_OP_NUM, 0, 0, 0};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_match_program_set (mock_program_df5_or_e1,
+                       sizeof (mock_program_df5_or_e1)));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_adv_match_program_set (unknown,
+                       sizeof (unknown)));
+    TEST_ASSERT_FALSE (app_adv_match_check (mock_flags, sizeof (mock_flags)));
+}
@@ -0,0 +1,306 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_adv_pool.h"
+#include "ruuvi_endpoint_ca_uart.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define STRESS_RECORDS (200000UL) //!< Records passed through pool in stress test.
+#define STRESS_TAGS    (8U)       //!< Tags spread over buckets in stress test.
+/** @brief Record of mock_scan, header and 7 bytes of data, aligned. */
+#define SHORT_LEN \
+    ((APP_ADV_POOL_RECORD_HEADER_LEN + 7U + APP_ADV_POOL_ALIGN - 1U) & ~(APP_ADV_POOL_ALIGN - 1U))
+
+static ri_adv_scan_t mock_scan =
+{
+    .addr = {0xFA, 0xEB, 0xDC, 0xCD, 0xBE, 0xAF},
+    .rssi = -50,
+    .data = {0x02, 0x01, 0x06, 0x03, 0xFF, 0x99, 0x04},
+    .data_len = 7,
+    .is_coded_phy = true,
+    .primary_phy = 3,
+    .secondary_phy = 2,
+    .ch_index = 12,
+    .tx_power = -4,
+};
+
+static const app_clock_stamp_t m_stamp =
+{
+    .ms = 1234UL
+};
+
+static app_clock_stamp_t m_rx;
+
+void setUp (void)
+{
+    app_adv_pool_init();
+}
+
+void tearDown (void)
+{
+}
+
+static void assert_scan_equal (const ri_adv_scan_t * const p_expected,
+                               const ri_adv_scan_t * const p_actual)
+{
+    TEST_ASSERT_EQUAL_HEX8_ARRAY (p_expected->addr, p_actual->addr,
+                                  sizeof (p_expected->addr));
+    TEST_ASSERT_EQUAL (p_expected->rssi, p_actual->rssi);
+    TEST_ASSERT_EQUAL (p_expected->data_len, p_actual->data_len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY (p_expected->data, p_actual->data, p_expected->data_len);
+    TEST_ASSERT_EQUAL (p_expected->is_coded_phy, p_actual->is_coded_phy);
+    TEST_ASSERT_EQUAL (p_expected->primary_phy, p_actual->primary_phy);
+    TEST_ASSERT_EQUAL (p_expected->secondary_phy, p_actual->secondary_phy);
+    TEST_ASSERT_EQUAL (p_expected->ch_index, p_actual->ch_index);
+    TEST_ASSERT_EQUAL (p_expected->tx_power, p_actual->tx_power);
+}
+
+void test_app_adv_pool_put_get (void)
+{
+    ri_adv_scan_t scan;
+    TEST_ASSERT_TRUE (app_adv_pool_is_empty());
+    TEST_ASSERT_FALSE (app_adv_pool_get (&scan, &m_rx));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&mock_scan, &m_stamp));
+    TEST_ASSERT_FALSE (app_adv_pool_is_empty());
+    TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+    assert_scan_equal (&mock_scan, &scan);
+    TEST_ASSERT_EQUAL (m_stamp.ms, m_rx.ms);
+    TEST_ASSERT_TRUE (app_adv_pool_is_empty());
+    TEST_ASSERT_FALSE (app_adv_pool_get (&scan, &m_rx));
+}
+
+void test_app_adv_pool_fifo_order (void)
+{
+    ri_adv_scan_t first = mock_scan;
+    ri_adv_scan_t second = mock_scan;
+    ri_adv_scan_t scan;
+    second.addr[5] = 0x01;
+    second.data_len = 3;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&first, &m_stamp));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&second, &m_stamp));
+    TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+    assert_scan_equal (&first, &scan);
+    TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+    assert_scan_equal (&second, &scan);
+}
+
+void test_app_adv_pool_holds_more_short_records (void)
+{
+    uint32_t count = 0;
+
+    while (RD_SUCCESS == app_adv_pool_put (&mock_scan, &m_stamp))
+    {
+        count++;
+    }
+
+    // One tag fills one bucket.
+    TEST_ASSERT_EQUAL ((APP_ADV_POOL_SIZE / APP_ADV_POOL_BUCKETS) / SHORT_LEN, count);
+    TEST_ASSERT_EQUAL (RD_ERROR_NO_MEM, app_adv_pool_put (&mock_scan, &m_stamp));
+}
+
+void test_app_adv_pool_wraps_with_pad (void)
+{
+    ri_adv_scan_t scan;
+    ri_adv_scan_t large = mock_scan;
+    large.data_len = RE_CA_UART_ADV_BYTES;
+
+    for (uint8_t ii = 0; ii < RE_CA_UART_ADV_BYTES; ii++)
+    {
+        large.data[ii] = ii;
+    }
+
+    // Walk write position around the ring several times with mixed sizes.
+    for (uint32_t ii = 0; ii < (4U * APP_ADV_POOL_SIZE / SHORT_LEN); ii++)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&mock_scan, &m_stamp));
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&large, &m_stamp));
+        TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+        assert_scan_equal (&mock_scan, &scan);
+        TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+        assert_scan_equal (&large, &scan);
+    }
+
+    TEST_ASSERT_FALSE (app_adv_pool_get (&scan, &m_rx));
+}
+
+void test_app_adv_pool_full_then_drained (void)
+{
+    ri_adv_scan_t scan;
+
+    while (RD_SUCCESS == app_adv_pool_put (&mock_scan, &m_stamp))
+    {
+    }
+
+    TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&mock_scan, &m_stamp));
+}
+
+void test_app_adv_pool_used_counts_records (void)
+{
+    ri_adv_scan_t scan;
+    TEST_ASSERT_EQUAL (0, app_adv_pool_used_get());
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&mock_scan, &m_stamp));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&mock_scan, &m_stamp));
+    TEST_ASSERT_EQUAL (2U * SHORT_LEN, app_adv_pool_used_get());
+    TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+    TEST_ASSERT_EQUAL (SHORT_LEN, app_adv_pool_used_get());
+}
+
+void test_app_adv_pool_fill_counts_full_buckets (void)
+{
+    ri_adv_scan_t scan = mock_scan;
+    TEST_ASSERT_EQUAL (0, app_adv_pool_fill_get());
+
+    // Fill every bucket until it refuses a short record.
+    for (uint32_t ii = 0; ii < (APP_ADV_POOL_SIZE / SHORT_LEN); ii++)
+    {
+        scan.addr[5] = (uint8_t) ii;
+        (void) app_adv_pool_put (&scan, &m_stamp);
+    }
+
+    TEST_ASSERT_EQUAL (100, app_adv_pool_fill_get());
+
+    while (app_adv_pool_get (&scan, &m_rx))
+    {
+    }
+
+    TEST_ASSERT_EQUAL (0, app_adv_pool_fill_get());
+}
+
+void test_app_adv_pool_fill_follows_fullest_bucket (void)
+{
+    while (RD_SUCCESS == app_adv_pool_put (&mock_scan, &m_stamp))
+    {
+    }
+
+    // Other buckets are empty, but next record of this tag is dropped.
+    TEST_ASSERT_EQUAL (100, app_adv_pool_fill_get());
+}
+
+void test_app_adv_pool_full_bucket_keeps_others (void)
+{
+    ri_adv_scan_t other = mock_scan;
+    // Differs in lowest bit of MAC hash.
+    other.addr[5] ^= 0x01U;
+
+    while (RD_SUCCESS == app_adv_pool_put (&mock_scan, &m_stamp))
+    {
+    }
+
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&other, &m_stamp));
+}
+
+void test_app_adv_pool_fair_across_buckets (void)
+{
+    ri_adv_scan_t other = mock_scan;
+    ri_adv_scan_t scan;
+    uint32_t chatty = 0;
+    other.addr[5] ^= 0x01U;
+
+    while (RD_SUCCESS == app_adv_pool_put (&mock_scan, &m_stamp))
+    {
+    }
+
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_adv_pool_put (&other, &m_stamp));
+    TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+
+    while (0 != memcmp (scan.addr, other.addr, sizeof (scan.addr)))
+    {
+        chatty++;
+        TEST_ASSERT_TRUE (app_adv_pool_get (&scan, &m_rx));
+    }
+
+    // Chatty bucket forwards at most its quantum of short records before other's turn.
+    TEST_ASSERT_LESS_OR_EQUAL ((APP_ADV_POOL_QUANTUM / SHORT_LEN), chatty);
+}
+
+void test_app_adv_pool_put_invalid (void)
+{
+    ri_adv_scan_t large = mock_scan;
+    large.data_len = RE_CA_UART_ADV_BYTES + 1U;
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_adv_pool_put (NULL, &m_stamp));
+    TEST_ASSERT_EQUAL (RD_ERROR_DATA_SIZE, app_adv_pool_put (&large, &m_stamp));
+}
+
+/** @brief Vary record size so that pads land on different offsets. */
+static size_t stress_data_len (const uint32_t seq)
+{
+    // Sequence number and a check byte after it.
+    const size_t min_len = sizeof (seq) + 1U;
+    return min_len + (seq % (RE_CA_UART_ADV_BYTES + 1U - min_len));
+}
+
+/** @brief Put records with a running sequence number, retrying while pool is full. */
+static void * stress_producer (void * p_arg)
+{
+    ri_adv_scan_t scan = mock_scan;
+    (void) p_arg;
+
+    for (uint32_t seq = 0; seq < STRESS_RECORDS; seq++)
+    {
+        memcpy (scan.data, &seq, sizeof (seq));
+        scan.addr[5] = (uint8_t) (seq % STRESS_TAGS);
+        scan.data_len = stress_data_len (seq);
+        scan.data[scan.data_len - 1U] = (uint8_t) seq;
+        const app_clock_stamp_t rx = {.ms = seq};
+
+        while (RD_ERROR_NO_MEM == app_adv_pool_put (&scan, &rx))
+        {
+            // Let consumer run on single core hosts.
+            (void) sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Producer and consumer run on separate threads to exercise the memory ordering
+ * of the pool indices. Consumer checks that every record arrives once, in order
+ * of its tag and intact.
+ */
+void test_app_adv_pool_stress_two_threads (void)
+{
+    pthread_t producer;
+    ri_adv_scan_t scan;
+    uint32_t expected[STRESS_TAGS];
+    uint32_t received = 0;
+    uint32_t errors = 0;
+
+    for (uint32_t ii = 0; ii < STRESS_TAGS; ii++)
+    {
+        expected[ii] = ii;
+    }
+
+    TEST_ASSERT_EQUAL (0, pthread_create (&producer, NULL, stress_producer, NULL));
+
+    while (received < STRESS_RECORDS)
+    {
+        if (app_adv_pool_get (&scan, &m_rx))
+        {
+            const uint8_t tag = scan.addr[5] % STRESS_TAGS;
+            uint32_t seq;
+            memcpy (&seq, scan.data, sizeof (seq));
+
+            if ((expected[tag] != seq) || (seq != m_rx.ms)
+                    || (stress_data_len (seq) != scan.data_len)
+                    || ((uint8_t) seq != scan.data[scan.data_len - 1U]))
+            {
+                errors++;
+            }
+
+            expected[tag] += STRESS_TAGS;
+            received++;
+        }
+        else
+        {
+            (void) sched_yield();
+        }
+    }
+
+    TEST_ASSERT_EQUAL (0, pthread_join (producer, NULL));
+    TEST_ASSERT_EQUAL (0, errors);
+    TEST_ASSERT_FALSE (app_adv_pool_get (&scan, &m_rx));
+}
@@ -1,13 +1,22 @@
 #include "unity.h"
 
 #include "app_ble.h"
+#include "app_config.h"
+#include "app_latency.h"
+#include "app_scan_schedule.h"
+#include "app_stats.h"
+#include "ble_gap.h"
 #include "ruuvi_boards.h"
+#include "mock_app_adv_filter.h"
+#include "mock_app_adv_pool.h"
+#include "mock_app_clock.h"
 #include "mock_app_uart.h"
 #include "mock_ruuvi_driver_error.h"
+#include "mock_ruuvi_interface_communication_ble_advertising.h"
 #include "mock_ruuvi_interface_communication_radio.h"
 #include "mock_ruuvi_interface_gpio.h"
 #include "mock_ruuvi_interface_log.h"
-#include "mock_ruuvi_interface_scheduler.h"
+#include "mock_ruuvi_interface_timer.h"
 #include "mock_ruuvi_interface_watchdog.h"
 #include "mock_ruuvi_task_advertisement.h"
 #include "mock_ruuvi_task_led.h"
@@ -16,6 +25,12 @@
 extern int GlobalExpectCount;
 extern int GlobalVerifyOrder;
 
+#define MOCK_NOW_CYCLES (0U)         //!< CPU cycle counter seen by code under test.
+#define MOCK_RX_MS      (1000U)      //!< Time advertisements were received.
+#define MOCK_ENTRY_MS   (2000U)      //!< Time scan schedule entries start.
+#define MOCK_NOW_TICKS  (50U)        //!< RTC counter seen by code under test.
+#define MOCK_RX_TICKS   (0xFFFFF0U)  //!< RTC counter at reception, wraps before now.
+
 void setUp (void)
 {
     ri_log_Ignore();
@@ -26,12 +41,25 @@ void setUp (void)
         .channel_38 = 1,
         .channel_39 = 1
     };
+    app_adv_filter_manufacturer_set_ExpectAnyArgs();
     app_ble_manufacturer_filter_set (true);
+    app_adv_filter_manufacturer_set_ExpectAnyArgs();
     app_ble_manufacturer_id_set (RB_BLE_MANUFACTURER_ID);
     app_ble_channels_set (channels);
     app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, false);
     app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, false);
     app_ble_modulation_enable (RI_RADIO_BLE_2MBPS, false);
+    app_ble_scan_mode_set (APP_BLE_SCAN_MODE_ALTERNATE);
+    app_ble_phy_share_set (APP_BLE_CODED_SHARE_MIN_PERCENT, APP_BLE_CODED_SHARE_MAX_PERCENT);
+    app_scan_schedule_set (NULL, 0);
+    app_ble_scan_timing_set (0, 0, 0);
+    app_ble_channel_dwell_set (false, APP_BLE_CHANNEL_SHARE_MIN_PERCENT,
+                               APP_BLE_CHANNEL_SHARE_MAX_PERCENT);
+    app_adv_filter_shed_peak_take_IgnoreAndReturn (APP_ADV_FILTER_SHED_NONE);
+    app_clock_cycles_get_IgnoreAndReturn (MOCK_NOW_CYCLES);
+    app_clock_ticks_get_IgnoreAndReturn (MOCK_NOW_TICKS);
+    app_latency_init();
+    app_stats_reset();
 }
 
 void tearDown (void)
@@ -250,6 +278,29 @@ void test_app_ble_scan_start_all_channels_1mbps (void)
     err_code |= app_ble_scan_start(); // Call the function under test
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_RESTART));
+}
+
+void test_app_ble_scan_start_shed_narrow_stays_on_1mbps (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    app_adv_filter_shed_peak_take_IgnoreAndReturn (APP_ADV_FILTER_SHED_NARROW);
+    rt_adv_uninit_ExpectAndReturn (RD_SUCCESS);
+    ri_radio_uninit_ExpectAndReturn (RD_SUCCESS);
+    ri_gpio_is_init_ExpectAndReturn (true);
+    ri_gpio_configure_ExpectAndReturn (RB_PA_CRX_PIN, RI_GPIO_MODE_INPUT_PULLUP, RD_SUCCESS);
+    ri_gpio_configure_ExpectAndReturn (RB_PA_CSD_PIN, RI_GPIO_MODE_OUTPUT_STANDARD,
+                                       RD_SUCCESS);
+    ri_gpio_write_ExpectAndReturn (RB_PA_CSD_PIN, RB_PA_CSD_ACTIVE, RD_SUCCESS);
+    // Without shedding the window after a 1M PHY window is on coded PHY.
+    ri_radio_init_ExpectAndReturn (RI_RADIO_BLE_1MBPS, RD_SUCCESS);
+    rt_adv_init_ExpectWithArrayAndReturn (&scan_params, 1, RD_SUCCESS);
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    err_code |= app_ble_scan_start(); // Call the function under test
+    TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
 void test_app_ble_scan_start_all_channels_2mbps (void)
@@ -326,6 +377,7 @@ void test_app_ble_scan_start_error_on_ri_radio_init (void)
     err_code |= app_ble_scan_start();
     TEST_ASSERT_EQUAL (RD_ERROR_INTERNAL, err_code);
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_SCAN_RESTART));
 }
 
 /**
@@ -372,6 +424,7 @@ void test_app_ble_scan_start_manufacturer_filter_disabled_sets_unknown_id (void)
 {
     rd_status_t err_code = RD_SUCCESS;
     // Disable manufacturer filter to trigger the `if (!manufacturer_filter_enabled)` branch
+    app_adv_filter_manufacturer_set_Expect (false, RB_BLE_MANUFACTURER_ID);
     app_ble_manufacturer_filter_set (false);
     // Enable a single modulation to allow scanning to start
     app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
@@ -492,17 +545,442 @@ void test_app_ble_scan_start_no_modulations_calls_stop (void)
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
+void test_app_ble_scan_mode_invalid (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_ble_scan_mode_set (APP_BLE_SCAN_MODE_NUM));
+}
+
+static void scan_restart_expect (const ri_radio_modulation_t modulation)
+{
+    rt_adv_uninit_ExpectAndReturn (RD_SUCCESS);
+    ri_radio_uninit_ExpectAndReturn (RD_SUCCESS);
+    ri_gpio_is_init_ExpectAndReturn (true);
+    ri_gpio_configure_ExpectAndReturn (RB_PA_CRX_PIN, RI_GPIO_MODE_INPUT_PULLUP, RD_SUCCESS);
+    ri_gpio_configure_ExpectAndReturn (RB_PA_CSD_PIN, RI_GPIO_MODE_OUTPUT_STANDARD,
+                                       RD_SUCCESS);
+    ri_gpio_write_ExpectAndReturn (RB_PA_CSD_PIN, RB_PA_CSD_ACTIVE, RD_SUCCESS);
+    ri_radio_init_ExpectAndReturn (modulation, RD_SUCCESS);
+    rt_adv_init_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+}
+
+void test_app_ble_scan_concurrent_rearms_on_timeout (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_mode_set (APP_BLE_SCAN_MODE_CONCURRENT));
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    // Window ends, same session is re-armed without radio restart.
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_RESTART));
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_SCAN_REARM));
+}
+
+void test_app_ble_scan_concurrent_restarts_on_change (void)
+{
+    const ri_radio_channels_t channels = {.channel_37 = 1};
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_2MBPS, true);
+    app_ble_scan_mode_set (APP_BLE_SCAN_MODE_CONCURRENT);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    app_ble_channels_set (channels);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_SCAN_RESTART));
+}
+
+static rt_adv_init_t m_adv_init; //!< Parameters of last rt_adv_init call.
+
+static rd_status_t rt_adv_init_capture (rt_adv_init_t * const p_params,
+                                        int cmock_num_calls)
+{
+    (void) cmock_num_calls;
+    m_adv_init = *p_params;
+    return RD_SUCCESS;
+}
+
+void test_app_ble_scan_concurrent_requests_both_phys (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_2MBPS, true);
+    app_ble_scan_mode_set (APP_BLE_SCAN_MODE_CONCURRENT);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    rt_adv_init_AddCallback (&rt_adv_init_capture);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    // 2M PHY data is announced on 1M primary PHY, which must be scanned too.
+    TEST_ASSERT_TRUE (m_adv_init.is_rx_le_1m_phy_enabled);
+    TEST_ASSERT_TRUE (m_adv_init.is_rx_le_2m_phy_enabled);
+    TEST_ASSERT_TRUE (m_adv_init.is_rx_le_coded_phy_enabled);
+}
+
+void test_app_ble_scan_concurrent_shed_narrow_restarts_on_1mbps (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    app_ble_scan_mode_set (APP_BLE_SCAN_MODE_CONCURRENT);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    app_adv_filter_shed_peak_take_IgnoreAndReturn (APP_ADV_FILTER_SHED_NARROW);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    // Narrow session alternates, so next window restarts radio again.
+    app_adv_filter_shed_peak_take_IgnoreAndReturn (APP_ADV_FILTER_SHED_NONE);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_scan_single_phy_rearms_on_timeout (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_RESTART));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_REARM));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_SCAN_REARM, 0));
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_SCAN_RESTART, 0));
+}
+
+void test_app_ble_scan_alternating_phys_restart_on_timeout (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    app_adv_filter_shed_peak_take_IgnoreAndReturn (APP_ADV_FILTER_SHED_NARROW);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    app_adv_filter_shed_peak_take_IgnoreAndReturn (APP_ADV_FILTER_SHED_NONE);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_SCAN_REARM));
+    TEST_ASSERT_EQUAL (2, app_latency_take (APP_LATENCY_STAGE_SCAN_RESTART, 0));
+}
+
+void test_app_ble_phy_share_invalid (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_phy_share_set (60U, 40U));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_phy_share_set (0U, 101U));
+}
+
+static void scan_window_rx (const uint32_t count)
+{
+    app_clock_ms_get_IgnoreAndReturn (1000U);
+    app_adv_filter_check_IgnoreAndReturn (APP_ADV_FILTER_ACCEPT);
+    app_adv_pool_put_IgnoreAndReturn (RD_SUCCESS);
+    app_adv_filter_commit_Ignore();
+
+    for (uint32_t ii = 0; ii < count; ii++)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &mock_scan,
+                           mock_scan_len));
+    }
+}
+
+void test_app_ble_scan_phy_share_follows_traffic (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    // No traffic yet, PHYs take turns.
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    scan_window_rx (10U);
+
+    // Only 1M PHY has traffic, coded PHY keeps its minimum share of 10%.
+    for (uint32_t ii = 0; ii < 4U; ii++)
+    {
+        rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+        TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    }
+
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (4, app_stats_get (APP_STATS_SCAN_REARM));
+}
+
+void test_app_ble_scan_phy_share_fixed_alternates (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_phy_share_set (50U, 50U));
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    scan_window_rx (10U);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_scan_rearm_error_restarts (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_ERROR_INVALID_STATE);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_SCAN_REARM));
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_SCAN_RESTART));
+}
+
+static const uint8_t mock_schedule[] =
+{
+    APP_SCAN_SCHEDULE_PHY_1M, APP_SCAN_SCHEDULE_CH_37, 0xF4, 0x01,
+    APP_SCAN_SCHEDULE_PHY_CODED, APP_SCAN_SCHEDULE_CH_38, 0xE8, 0x03,
+};
+
+static void schedule_entry_expect (const ri_radio_modulation_t modulation,
+                                   const uint32_t window_ms)
+{
+    scan_restart_expect (modulation);
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_timer_start_ExpectAndReturn (NULL, window_ms, NULL, RD_SUCCESS);
+    app_clock_ms_get_ExpectAndReturn (MOCK_ENTRY_MS);
+}
+
+static void schedule_timer_fire (const uint32_t spent_ms)
+{
+    app_clock_ms_get_ExpectAndReturn (MOCK_ENTRY_MS + spent_ms);
+    rt_adv_scan_stop_ExpectAndReturn (RD_SUCCESS);
+}
+
+static void schedule_stop_expect (void)
+{
+    ri_timer_stop_ExpectAndReturn (NULL, RD_SUCCESS);
+    rt_adv_scan_stop_ExpectAndReturn (RD_SUCCESS);
+}
+
+void test_app_ble_scan_schedule_runs_entries (void)
+{
+    // Schedule scans even though all PHYs are disabled.
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (mock_schedule,
+                       sizeof (mock_schedule)));
+    schedule_entry_expect (RI_RADIO_BLE_1MBPS, 500U);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    schedule_timer_fire (500U);
+    schedule_entry_expect (RI_RADIO_BLE_125KBPS, 1000U);
+    app_ble_on_schedule_timer (NULL);
+    schedule_stop_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_stop());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (500, app_scan_schedule_time_take (0));
+    TEST_ASSERT_EQUAL (0, app_scan_schedule_time_take (1));
+}
+
+void test_app_ble_scan_schedule_rearms_within_entry (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (mock_schedule,
+                       sizeof (mock_schedule)));
+    schedule_entry_expect (RI_RADIO_BLE_1MBPS, 500U);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    // Driver window ends before entry, scan stays on entry.
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    schedule_stop_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_stop());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_REARM));
+}
+
+void test_app_ble_scan_schedule_single_entry_rearms (void)
+{
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (mock_schedule,
+                       APP_SCAN_SCHEDULE_ENTRY_LEN));
+    schedule_entry_expect (RI_RADIO_BLE_1MBPS, 500U);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    schedule_timer_fire (500U);
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_timer_start_ExpectAndReturn (NULL, 500U, NULL, RD_SUCCESS);
+    app_clock_ms_get_ExpectAndReturn (MOCK_ENTRY_MS + 500U);
+    app_ble_on_schedule_timer (NULL);
+    schedule_stop_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_stop());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_REARM));
+}
+
+void test_app_ble_scan_schedule_cleared_returns_to_modulations (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_125KBPS, true);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (mock_schedule,
+                       sizeof (mock_schedule)));
+    schedule_entry_expect (RI_RADIO_BLE_1MBPS, 500U);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (NULL, 0));
+    ri_timer_stop_ExpectAndReturn (NULL, RD_SUCCESS);
+    scan_restart_expect (RI_RADIO_BLE_125KBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_channel_dwell_invalid (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_channel_dwell_set (true, 0, 50U));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_channel_dwell_set (true, 60U, 40U));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_channel_dwell_set (true, 10U, 101U));
+}
+
+void test_app_ble_scan_channel_dwell_follows_yield (void)
+{
+    const ri_radio_channels_t channels = {.channel_37 = 1, .channel_38 = 1};
+    // Re-armed on same channel, restarted on channel change.
+    const char windows[] = "ARRAAAAAAAAR";
+    ri_adv_scan_t scan = mock_scan;
+    scan.ch_index = 37;
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    app_ble_channels_set (channels);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_channel_dwell_set (true, 10U, 90U));
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    app_clock_ms_get_IgnoreAndReturn (1000U);
+    app_adv_filter_check_IgnoreAndReturn (APP_ADV_FILTER_ACCEPT);
+    app_adv_pool_put_IgnoreAndReturn (RD_SUCCESS);
+    app_adv_filter_commit_Ignore();
+
+    for (uint32_t ii = 0; ii < 10U; ii++)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &scan, sizeof (scan)));
+    }
+
+    // Only channel 37 has traffic, channel 38 keeps its minimum weight of 10%.
+    for (size_t ii = 0; ii < (sizeof (windows) - 1U); ii++)
+    {
+        if ('A' == windows[ii])
+        {
+            rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+        }
+        else
+        {
+            scan_restart_expect (RI_RADIO_BLE_1MBPS);
+        }
+
+        TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    }
+
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (9, app_stats_get (APP_STATS_SCAN_REARM));
+    TEST_ASSERT_EQUAL (4, app_stats_get (APP_STATS_SCAN_RESTART));
+}
+
+void test_app_ble_scan_channel_dwell_off_scans_all_channels (void)
+{
+    ri_adv_scan_t scan = mock_scan;
+    scan.ch_index = 37;
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    app_clock_ms_get_IgnoreAndReturn (1000U);
+    app_adv_filter_check_IgnoreAndReturn (APP_ADV_FILTER_ACCEPT);
+    app_adv_pool_put_IgnoreAndReturn (RD_SUCCESS);
+    app_adv_filter_commit_Ignore();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &scan, sizeof (scan)));
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_scan_timing_invalid (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_scan_timing_set (100U, 0, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_scan_timing_set (0, 100U, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_scan_timing_set (100U, 200U, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_ble_scan_timing_set (100U, APP_BLE_SCAN_INTERVAL_MIN_MS - 1U, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_ble_scan_timing_set (APP_BLE_SCAN_INTERVAL_MAX_MS + 1U, 100U, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_ble_scan_timing_set (0, 0, APP_BLE_SCAN_TIMEOUT_MIN_MS - 1U));
+}
+
+void test_app_ble_scan_timing_concurrent_needs_double_interval (void)
+{
+    // Both primary PHYs share each interval, window must fit twice.
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_timing_set (100U, 100U, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_STATE,
+                       app_ble_scan_mode_set (APP_BLE_SCAN_MODE_CONCURRENT));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_timing_set (200U, 100U, 0));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_mode_set (APP_BLE_SCAN_MODE_CONCURRENT));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_ble_scan_timing_set (200U, 101U, 0));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_timing_set (0, 0, 0));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_mode_set (APP_BLE_SCAN_MODE_ALTERNATE));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_timing_set (100U, 100U, 0));
+}
+
+void test_app_ble_scan_timing_applies_on_rearm (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_timing_set (500U, 100U, 0));
+    // Radio is not restarted, only the scan is re-armed with new timing.
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    ri_adv_scan_stop_ExpectAndReturn (RD_SUCCESS);
+    ri_adv_scan_start_ExpectAndReturn (500U, 100U, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_RESTART));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_SCAN_REARM));
+}
+
+void test_app_ble_scan_timing_timeout_ends_window (void)
+{
+    app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_timing_set (0, 0, 1000U));
+    scan_restart_expect (RI_RADIO_BLE_1MBPS);
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_timer_start_ExpectAndReturn (NULL, 1000U, NULL, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_start());
+    // Timeout ends the window before driver does.
+    rt_adv_scan_stop_ExpectAndReturn (RD_SUCCESS);
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_timer_start_ExpectAndReturn (NULL, 1000U, NULL, RD_SUCCESS);
+    app_ble_on_window_timer (NULL);
+    // Driver window ends first, timeout restarts with next window.
+    ri_timer_stop_ExpectAndReturn (NULL, RD_SUCCESS);
+    rt_adv_scan_start_ExpectAndReturn (&on_scan_isr, RD_SUCCESS);
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_timer_start_ExpectAndReturn (NULL, 1000U, NULL, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_TIMEOUT, NULL, 0));
+    ri_timer_stop_ExpectAndReturn (NULL, RD_SUCCESS);
+    rt_adv_scan_stop_ExpectAndReturn (RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ble_scan_stop());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_SCAN_REARM));
+}
+
 /**
  * @brief Handle Scan events.
  *
- * Received data is put to scheduler queue, new scan with new PHY is started on timeout.
+ * Received data is stored in app_adv_pool, new scan with new PHY is started on timeout.
  *
  * @param[in] evt Type of event, either RI_COMM_RECEIVED on data or
  *                RI_COMM_TIMEOUT on scan timeout.
  * @param[in] p_data NULL on timeout, ri_adv_scan_t* on received.
  * @param[in] data_len 0 on timeout, size of ri_adv_scan_t on received.
  * @retval RD_SUCCESS on successful handling on event.
- * @retval RD_ERR_NO_MEM if received event could not be put to scheduler queue.
+ * @retval RD_ERR_NO_MEM if received data could not be stored.
  * @return Error code from scanning if scan cannot be started.
  *
  * @note parameters are not const to maintain compatibility with the event handler
@@ -512,14 +990,86 @@ void test_app_ble_scan_start_no_modulations_calls_stop (void)
 void test_app_ble_on_scan_isr_received (void)
 {
     rd_status_t err_code = RD_SUCCESS;
-    char received[] = "Ave Mundi!";
-    ri_scheduler_event_put_ExpectAndReturn (received, strlen (received), &repeat_adv,
-                                            RD_SUCCESS);
-    err_code |= on_scan_isr (RI_COMM_RECEIVED, received, strlen (received));
+    const app_clock_stamp_t rx = {.ms = 1000U};
+    app_clock_ms_get_ExpectAndReturn (1000U);
+    app_adv_filter_check_ExpectAndReturn (&mock_scan, mock_scan_len, APP_ADV_FILTER_ACCEPT);
+    app_adv_pool_put_ExpectAndReturn (&mock_scan, &rx, RD_SUCCESS);
+    app_adv_filter_commit_Expect();
+    err_code |= on_scan_isr (RI_COMM_RECEIVED, &mock_scan, mock_scan_len);
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
+void test_app_ble_on_scan_isr_received_filtered (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    app_clock_ms_get_ExpectAndReturn (1000U);
+    app_adv_filter_check_ExpectAndReturn (&mock_scan, mock_scan_len,
+                                          APP_ADV_FILTER_REJECT_MANUFACTURER);
+    err_code |= on_scan_isr (RI_COMM_RECEIVED, &mock_scan, mock_scan_len);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    // Filtered advertisements were still received.
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CH_SECONDARY));
+}
+
+void test_app_ble_on_scan_isr_received_counts_phy_and_channel (void)
+{
+    ri_adv_scan_t legacy = mock_scan;
+    ri_adv_scan_t extended = mock_scan;
+    legacy.primary_phy = BLE_GAP_PHY_1MBPS;
+    legacy.secondary_phy = BLE_GAP_PHY_NOT_SET;
+    legacy.ch_index = 38;
+    extended.primary_phy = BLE_GAP_PHY_CODED;
+    extended.secondary_phy = BLE_GAP_PHY_CODED;
+    extended.ch_index = 12;
+    app_clock_ms_get_IgnoreAndReturn (1000U);
+    app_adv_filter_check_IgnoreAndReturn (APP_ADV_FILTER_REJECT_RSSI);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &legacy, sizeof (legacy)));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &extended,
+                       sizeof (extended)));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_1MBPS));
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_RX_2MBPS));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CODED));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CH_38));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CH_SECONDARY));
+}
+
+void test_app_ble_on_scan_isr_received_counts_channel_yield (void)
+{
+    ri_adv_scan_t scan = mock_scan;
+    scan.ch_index = 39;
+    app_clock_ms_get_IgnoreAndReturn (1000U);
+    app_adv_filter_check_ExpectAndReturn (&scan, sizeof (scan), APP_ADV_FILTER_ACCEPT);
+    app_adv_pool_put_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    app_adv_filter_commit_Expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &scan, sizeof (scan)));
+    app_adv_filter_check_ExpectAndReturn (&scan, sizeof (scan),
+                                          APP_ADV_FILTER_REJECT_INVALID);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &scan, sizeof (scan)));
+    app_adv_filter_check_ExpectAndReturn (&scan, sizeof (scan),
+                                          APP_ADV_FILTER_REJECT_RSSI);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, on_scan_isr (RI_COMM_RECEIVED, &scan, sizeof (scan)));
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    TEST_ASSERT_EQUAL (3, app_stats_get (APP_STATS_RX_CH_39));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_ACCEPT_CH_39));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_INVALID_CH_39));
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_ACCEPT_CH_37));
+}
+
+void test_app_ble_on_scan_isr_received_queue_full (void)
+{
+    rd_status_t err_code = RD_SUCCESS;
+    const app_clock_stamp_t rx = {.ms = 1000U};
+    app_clock_ms_get_ExpectAndReturn (1000U);
+    app_adv_filter_check_ExpectAndReturn (&mock_scan, mock_scan_len, APP_ADV_FILTER_ACCEPT);
+    app_adv_pool_put_ExpectAndReturn (&mock_scan, &rx, RD_ERROR_NO_MEM);
+    app_adv_filter_reject_Expect (APP_ADV_FILTER_REJECT_QUEUE_FULL);
+    err_code |= on_scan_isr (RI_COMM_RECEIVED, &mock_scan, mock_scan_len);
+    TEST_ASSERT_EQUAL (RD_ERROR_NO_MEM, err_code);
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
 void test_app_ble_on_scan_isr_timeout (void)
 {
     app_ble_modulation_enable (RI_RADIO_BLE_1MBPS, true);
@@ -567,33 +1117,143 @@ void test_app_ble_scan_stop_error_propagates (void)
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
-void test_repeat_adv_ok (void)
+static void pool_get_expect (const uint32_t rx_ms, const uint32_t now_ms)
 {
-    rd_status_t err_code = RD_SUCCESS;
-    app_uart_send_broadcast_ExpectAndReturn (&mock_scan, RD_SUCCESS);
-    ri_watchdog_feed_ExpectAndReturn (RD_SUCCESS);
-    repeat_adv (&mock_scan, mock_scan_len);
-    TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
+    static app_clock_stamp_t pool_rx;
+    pool_rx.ms = rx_ms;
+    pool_rx.ticks = MOCK_RX_TICKS;
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (true);
+    app_adv_pool_get_ReturnThruPtr_p_scan (&mock_scan);
+    app_adv_pool_get_ReturnThruPtr_p_rx (&pool_rx);
+    app_clock_ms_get_ExpectAndReturn (now_ms);
+}
+
+static void forward_one_expect (const rd_status_t send_status)
+{
+    pool_get_expect (MOCK_RX_MS, 1100U);
+    app_uart_send_broadcast_ExpectAndReturn (&mock_scan, MOCK_RX_TICKS, send_status);
+
+    if (RD_SUCCESS == send_status)
+    {
+        ri_watchdog_feed_ExpectAndReturn (RD_SUCCESS);
+    }
+}
+
+void test_app_ble_adv_forward_ok (void)
+{
+    forward_one_expect (RD_SUCCESS);
+    forward_one_expect (RD_SUCCESS);
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (false);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
-void test_repeat_adv_incorrect_len (void)
+void test_app_ble_adv_forward_empty_pool (void)
 {
-    rd_status_t err_code = RD_SUCCESS;
-    repeat_adv (&mock_scan, (mock_scan_len - 1));
-    TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (false);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_adv_forward_send_error (void)
+{
+    forward_one_expect (RD_ERROR_DATA_SIZE);
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (false);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_adv_forward_budget (void)
+{
+    for (uint32_t ii = 0; ii < APP_BLE_ADV_FORWARD_BUDGET; ii++)
+    {
+        forward_one_expect (RD_SUCCESS);
+    }
+
+    app_adv_pool_is_empty_ExpectAndReturn (false);
+    TEST_ASSERT_TRUE (app_ble_adv_forward());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+}
+
+void test_app_ble_adv_forward_budget_pool_emptied (void)
+{
+    for (uint32_t ii = 0; ii < APP_BLE_ADV_FORWARD_BUDGET; ii++)
+    {
+        forward_one_expect (RD_SUCCESS);
+    }
+
+    app_adv_pool_is_empty_ExpectAndReturn (true);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
-void test_repeat_adv_send_error (void)
+void test_app_ble_adv_forward_waits_for_tx_queue (void)
 {
-    rd_status_t err_code = RD_ERROR_DATA_SIZE;
-    app_uart_send_broadcast_ExpectAndReturn (NULL, RD_ERROR_DATA_SIZE);
-    repeat_adv (NULL, mock_scan_len);
-    TEST_ASSERT_EQUAL (RD_ERROR_DATA_SIZE, err_code);
+    forward_one_expect (RD_SUCCESS);
+    app_uart_tx_queue_is_full_ExpectAndReturn (true);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
     TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
 }
 
+void test_app_ble_adv_forward_records_pool_latency (void)
+{
+    forward_one_expect (RD_SUCCESS);
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (false);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
+    // 66 ticks over counter wrap is 2014 us, in bucket of 1024 ... 2047 us.
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_POOL, 10));
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_UART, 10));
+}
+
+void test_app_ble_adv_forward_drops_stale (void)
+{
+    app_ble_adv_age_t age = {0};
+    app_ble_adv_age_take (&age);
+    app_ble_adv_max_age_set (500U);
+    pool_get_expect (MOCK_RX_MS, 1600U);
+    app_adv_filter_reject_Expect (APP_ADV_FILTER_REJECT_STALE);
+    pool_get_expect (MOCK_RX_MS, 1500U);
+    app_uart_send_broadcast_ExpectAndReturn (&mock_scan, MOCK_RX_TICKS, RD_SUCCESS);
+    ri_watchdog_feed_ExpectAndReturn (RD_SUCCESS);
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (false);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
+    TEST_ASSERT_EQUAL (GlobalExpectCount, GlobalVerifyOrder);
+    app_ble_adv_age_take (&age);
+    TEST_ASSERT_EQUAL (1, age.count);
+    TEST_ASSERT_EQUAL (500, age.max_ms);
+    app_ble_adv_max_age_set (0);
+}
+
+void test_app_ble_adv_forward_age_stats (void)
+{
+    app_ble_adv_age_t age = {0};
+    app_ble_adv_age_take (&age);
+    pool_get_expect (MOCK_RX_MS, 1100U);
+    app_uart_send_broadcast_ExpectAndReturn (&mock_scan, MOCK_RX_TICKS, RD_SUCCESS);
+    ri_watchdog_feed_ExpectAndReturn (RD_SUCCESS);
+    pool_get_expect (MOCK_RX_MS, 1300U);
+    app_uart_send_broadcast_ExpectAndReturn (&mock_scan, MOCK_RX_TICKS, RD_SUCCESS);
+    ri_watchdog_feed_ExpectAndReturn (RD_SUCCESS);
+    app_uart_tx_queue_is_full_ExpectAndReturn (false);
+    app_adv_pool_get_ExpectAnyArgsAndReturn (false);
+    TEST_ASSERT_FALSE (app_ble_adv_forward());
+    app_ble_adv_age_take (&age);
+    TEST_ASSERT_EQUAL (2, age.count);
+    TEST_ASSERT_EQUAL (200, age.mean_ms);
+    TEST_ASSERT_EQUAL (300, age.max_ms);
+    // Statistics restart when taken.
+    app_ble_adv_age_take (&age);
+    TEST_ASSERT_EQUAL (0, age.count);
+    TEST_ASSERT_EQUAL (0, age.mean_ms);
+    TEST_ASSERT_EQUAL (0, age.max_ms);
+}
+
 /**
  * Tests for app_ble_manufacturer_filter_enabled()
  */
@@ -608,6 +1268,7 @@ void test_app_ble_manufacturer_filter_enabled_default (void)
 void test_app_ble_manufacturer_filter_enabled_disabled (void)
 {
     // Disable the filter and verify the state and that manufacturer ID remains unchanged
+    app_adv_filter_manufacturer_set_Expect (false, RB_BLE_MANUFACTURER_ID);
     app_ble_manufacturer_filter_set (false);
     uint16_t manufacturer_id = 0;
     const bool enabled = app_ble_manufacturer_filter_enabled (&manufacturer_id);
@@ -619,6 +1280,7 @@ void test_app_ble_manufacturer_filter_enabled_changed_id (void)
 {
     // Change manufacturer ID and verify it is returned while keeping current enabled state
     const uint16_t NEW_ID = 0x1234;
+    app_adv_filter_manufacturer_set_Expect (true, NEW_ID);
     app_ble_manufacturer_id_set (NEW_ID);
     uint16_t manufacturer_id = 0;
     const bool enabled = app_ble_manufacturer_filter_enabled (&manufacturer_id);
@@ -0,0 +1,166 @@
+#include "unity.h"
+
+#include "app_ca_uart_ext.h"
+#include <string.h>
+
+#define MOCK_FRAME_MAX (200U)
+
+void setUp (void)
+{
+}
+
+void tearDown (void)
+{
+}
+
+static re_ca_uart_ble_adv_t mock_adv (const uint8_t adv_len)
+{
+    re_ca_uart_ble_adv_t adv = {0};
+    const uint8_t mac[] = {0xFA, 0xEB, 0xDC, 0xCD, 0xBE, 0xAF};
+    memcpy (adv.mac, mac, sizeof (adv.mac));
+    memset (adv.adv, 0x5A, adv_len);
+    adv.adv_len = adv_len;
+    adv.rssi_db = -60;
+    adv.ch_index = 37;
+    adv.is_coded_phy = true;
+    return adv;
+}
+
+void test_app_ca_uart_ext_encode_decode_ok (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = sizeof (buf);
+    const uint8_t payload[] = {APP_CA_UART_EXT_REPORT_BATCH, 5};
+    app_ca_uart_ext_frame_t frame = {0};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_encode (buf, &len,
+                       APP_CA_UART_EXT_SET_REPORT_MODE, payload, sizeof (payload)));
+    TEST_ASSERT_EQUAL (sizeof (payload) + APP_CA_UART_EXT_OVERHEAD, len);
+    TEST_ASSERT_EQUAL_HEX8 (RE_CA_UART_STX, buf[0]);
+    TEST_ASSERT_EQUAL (sizeof (payload) + CMD_IN_LEN, buf[1]);
+    TEST_ASSERT_EQUAL_HEX8 (RE_CA_UART_ETX, buf[len - 1U]);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (buf, len, &frame));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_SET_REPORT_MODE, frame.cmd);
+    TEST_ASSERT_EQUAL (sizeof (payload), frame.payload_len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY (payload, frame.p_payload, sizeof (payload));
+}
+
+void test_app_ca_uart_ext_encode_no_payload (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = sizeof (buf);
+    app_ca_uart_ext_frame_t frame = {0};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_encode (buf, &len, APP_CA_UART_EXT_ACK,
+                       NULL, 0));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_OVERHEAD, len);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (buf, len, &frame));
+    TEST_ASSERT_EQUAL (0, frame.payload_len);
+}
+
+void test_app_ca_uart_ext_encode_null (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = sizeof (buf);
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_ca_uart_ext_encode (NULL, &len,
+                       APP_CA_UART_EXT_ACK, NULL, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_ca_uart_ext_encode (buf, &len,
+                       APP_CA_UART_EXT_ACK, NULL, 1));
+}
+
+void test_app_ca_uart_ext_encode_too_small (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = APP_CA_UART_EXT_OVERHEAD + 1U;
+    const uint8_t payload[] = {1, 2};
+    TEST_ASSERT_EQUAL (RD_ERROR_DATA_SIZE, app_ca_uart_ext_encode (buf, &len,
+                       APP_CA_UART_EXT_ACK, payload, sizeof (payload)));
+}
+
+void test_app_ca_uart_ext_decode_rejects_endpoint_command (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = sizeof (buf);
+    app_ca_uart_ext_frame_t frame = {0};
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_encode (buf, &len,
+                       RE_CA_UART_GET_DEVICE_ID, NULL, 0));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_DATA, app_ca_uart_ext_decode (buf, len, &frame));
+}
+
+void test_app_ca_uart_ext_decode_bad_crc (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = sizeof (buf);
+    const uint8_t payload[] = {1, 2};
+    app_ca_uart_ext_frame_t frame = {0};
+    app_ca_uart_ext_encode (buf, &len, APP_CA_UART_EXT_SET_REPORT_MODE, payload,
+                            sizeof (payload));
+    buf[3] ^= 0x01U;
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_DATA, app_ca_uart_ext_decode (buf, len, &frame));
+}
+
+void test_app_ca_uart_ext_decode_truncated (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = sizeof (buf);
+    const uint8_t payload[] = {1, 2};
+    app_ca_uart_ext_frame_t frame = {0};
+    app_ca_uart_ext_encode (buf, &len, APP_CA_UART_EXT_SET_REPORT_MODE, payload,
+                            sizeof (payload));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_DATA, app_ca_uart_ext_decode (buf, len - 1U,
+                       &frame));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_DATA, app_ca_uart_ext_decode (buf, 2, &frame));
+}
+
+void test_app_ca_uart_ext_decode_null (void)
+{
+    app_ca_uart_ext_frame_t frame = {0};
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_ca_uart_ext_decode (NULL, 8, &frame));
+}
+
+void test_app_ca_uart_ext_batch_roundtrip (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = 0;
+    const re_ca_uart_ble_adv_t adv = mock_adv (24);
+    app_ca_uart_ext_frame_t frame = {0};
+    app_ca_uart_ext_batch_init (buf, &len);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_batch_add (buf, &len, sizeof (buf), &adv));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_batch_add (buf, &len, sizeof (buf), &adv));
+    TEST_ASSERT_EQUAL (2, app_ca_uart_ext_batch_count (buf));
+    app_ca_uart_ext_batch_close (buf, &len);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (buf, len, &frame));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_ADV_BATCH, frame.cmd);
+    TEST_ASSERT_EQUAL (1U + 2U * (APP_CA_UART_EXT_ADV_RECORD_HEADER_LEN + 24U),
+                       frame.payload_len);
+    TEST_ASSERT_EQUAL (2, frame.p_payload[0]);
+    // First record: MAC, RSSI, PHYs, channel, flags, TX power, length, data.
+    TEST_ASSERT_EQUAL_HEX8_ARRAY (adv.mac, &frame.p_payload[1], sizeof (adv.mac));
+    TEST_ASSERT_EQUAL_INT8 (-60, (int8_t) frame.p_payload[7]);
+    TEST_ASSERT_EQUAL (37, frame.p_payload[10]);
+    TEST_ASSERT_EQUAL (1, frame.p_payload[11]);
+    TEST_ASSERT_EQUAL (24, frame.p_payload[13]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY (adv.adv, &frame.p_payload[14], 24);
+}
+
+void test_app_ca_uart_ext_batch_full (void)
+{
+    uint8_t buf[MOCK_FRAME_MAX] = {0};
+    uint8_t len = 0;
+    uint8_t full_len = 0;
+    const re_ca_uart_ble_adv_t adv = mock_adv (24);
+    size_t added = 0;
+    app_ca_uart_ext_batch_init (buf, &len);
+
+    while (RD_SUCCESS == app_ca_uart_ext_batch_add (buf, &len, sizeof (buf), &adv))
+    {
+        added++;
+    }
+
+    full_len = len;
+    TEST_ASSERT_EQUAL ((sizeof (buf) - APP_CA_UART_EXT_OVERHEAD - 1U)
+                       / (APP_CA_UART_EXT_ADV_RECORD_HEADER_LEN + 24U), added);
+    TEST_ASSERT_EQUAL (RD_ERROR_NO_MEM, app_ca_uart_ext_batch_add (buf, &len, sizeof (buf),
+                       &adv));
+    TEST_ASSERT_EQUAL (full_len, len);
+    app_ca_uart_ext_batch_close (buf, &len);
+    TEST_ASSERT_TRUE (sizeof (buf) >= len);
+}
@@ -0,0 +1,47 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_clock.h"
+#include "mock_ruuvi_interface_timer.h"
+
+void setUp (void)
+{
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_clock_init_ok (void)
+{
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_timer_start_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_clock_init());
+    TEST_ASSERT_EQUAL (0, app_clock_ms_get());
+}
+
+void test_app_clock_init_create_error (void)
+{
+    ri_timer_create_ExpectAnyArgsAndReturn (RD_ERROR_RESOURCES);
+    TEST_ASSERT_EQUAL (RD_ERROR_RESOURCES, app_clock_init());
+}
+
+void test_app_clock_on_tick_advances (void)
+{
+    test_app_clock_init_ok();
+    app_clock_on_tick (NULL);
+    app_clock_on_tick (NULL);
+    TEST_ASSERT_EQUAL (2U * APP_CLOCK_TICK_MS, app_clock_ms_get());
+}
+
+void test_app_clock_cycles_get (void)
+{
+    app_clock_test_cycles_set (12345U);
+    TEST_ASSERT_EQUAL (12345U, app_clock_cycles_get());
+}
+
+void test_app_clock_ticks_get (void)
+{
+    app_clock_test_ticks_set (54321U);
+    TEST_ASSERT_EQUAL (54321U, app_clock_ticks_get());
+}
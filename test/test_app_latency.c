@@ -0,0 +1,84 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_latency.h"
+#include "mock_app_clock.h"
+
+#define US(x) ((x) * APP_CLOCK_CYCLES_PER_US) //!< Microseconds to CPU cycles.
+
+void setUp (void)
+{
+    app_latency_init();
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_latency_log2_buckets (void)
+{
+    app_latency_record_cycles (APP_LATENCY_STAGE_POOL, 0);
+    app_latency_record_cycles (APP_LATENCY_STAGE_POOL, US (1U));
+    app_latency_record_cycles (APP_LATENCY_STAGE_POOL, US (2U));
+    app_latency_record_cycles (APP_LATENCY_STAGE_POOL, US (3U));
+    app_latency_record_cycles (APP_LATENCY_STAGE_POOL, US (1000U));
+    app_latency_record_cycles (APP_LATENCY_STAGE_POOL, US (1024U));
+    TEST_ASSERT_EQUAL (2, app_latency_take (APP_LATENCY_STAGE_POOL, 0));
+    TEST_ASSERT_EQUAL (2, app_latency_take (APP_LATENCY_STAGE_POOL, 1));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_POOL, 9));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_POOL, 10));
+}
+
+void test_app_latency_last_bucket_collects_long (void)
+{
+    app_latency_record_cycles (APP_LATENCY_STAGE_TOTAL, UINT32_MAX);
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_TOTAL,
+                                            APP_LATENCY_BUCKETS - 1U));
+}
+
+void test_app_latency_stages_are_separate (void)
+{
+    app_latency_record_cycles (APP_LATENCY_STAGE_UART, US (100U));
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_POOL, 6));
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_TOTAL, 6));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_UART, 6));
+}
+
+void test_app_latency_take_clears (void)
+{
+    app_latency_record_cycles (APP_LATENCY_STAGE_UART, US (100U));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_UART, 6));
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_UART, 6));
+}
+
+void test_app_latency_count_saturates (void)
+{
+    for (uint32_t ii = 0; ii <= UINT16_MAX; ii++)
+    {
+        app_latency_record_cycles (APP_LATENCY_STAGE_POOL, 0);
+    }
+
+    TEST_ASSERT_EQUAL (UINT16_MAX, app_latency_take (APP_LATENCY_STAGE_POOL, 0));
+}
+
+void test_app_latency_record_ticks (void)
+{
+    app_latency_record_ticks (APP_LATENCY_STAGE_TOTAL, 0);
+    // 115 ticks is 3.5 ms, a 40 byte UART frame, in bucket of 2048 ... 4095 us.
+    app_latency_record_ticks (APP_LATENCY_STAGE_TOTAL, 115U);
+    // 32 ticks over counter wrap is 977 us, in bucket of 512 ... 1023 us.
+    app_latency_record_ticks (APP_LATENCY_STAGE_TOTAL, 0x10U - 0xFFFFF0U);
+    app_latency_record_ticks (APP_LATENCY_STAGE_TOTAL, APP_CLOCK_TICKS_MASK);
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_TOTAL, 0));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_TOTAL, 11));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_TOTAL, 9));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_TOTAL,
+                                            APP_LATENCY_BUCKETS - 1U));
+}
+
+void test_app_latency_out_of_range (void)
+{
+    app_latency_record_cycles (APP_LATENCY_STAGE_NUM, 0);
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_NUM, 0));
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_POOL, APP_LATENCY_BUCKETS));
+}
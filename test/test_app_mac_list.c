@@ -0,0 +1,146 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_mac_list.h"
+#include <string.h>
+
+static void mock_mac (uint8_t * const p_mac, const uint16_t id)
+{
+    const uint8_t mac[APP_MAC_LIST_MAC_LEN] =
+    {
+        0xFA, 0xEB, 0xDC, 0xCD, (uint8_t) (id >> 8U), (uint8_t) id
+    };
+    memcpy (p_mac, mac, sizeof (mac));
+}
+
+void setUp (void)
+{
+    app_mac_list_clear();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_OFF));
+    app_mac_list_clear();
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_mac_list_off_passes_all (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+    mock_mac (mac, 1);
+    TEST_ASSERT_TRUE (app_mac_list_is_passed (mac));
+}
+
+void test_app_mac_list_allow (void)
+{
+    uint8_t macs[3U * APP_MAC_LIST_MAC_LEN];
+    uint8_t other[APP_MAC_LIST_MAC_LEN];
+
+    for (uint16_t ii = 0; ii < 3U; ii++)
+    {
+        mock_mac (&macs[ii * APP_MAC_LIST_MAC_LEN], ii);
+    }
+
+    mock_mac (other, 3);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (macs, 3));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+
+    for (uint16_t ii = 0; ii < 3U; ii++)
+    {
+        TEST_ASSERT_TRUE (app_mac_list_is_passed (&macs[ii * APP_MAC_LIST_MAC_LEN]));
+    }
+
+    TEST_ASSERT_FALSE (app_mac_list_is_passed (other));
+}
+
+void test_app_mac_list_deny (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+    uint8_t other[APP_MAC_LIST_MAC_LEN];
+    mock_mac (mac, 1);
+    mock_mac (other, 2);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mac, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_DENY));
+    TEST_ASSERT_FALSE (app_mac_list_is_passed (mac));
+    TEST_ASSERT_TRUE (app_mac_list_is_passed (other));
+}
+
+void test_app_mac_list_add_ignores_duplicates (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+    mock_mac (mac, 1);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mac, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mac, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    TEST_ASSERT_EQUAL (1, app_mac_list_count());
+}
+
+void test_app_mac_list_add_full (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+
+    for (uint16_t ii = 0; ii < APP_MAC_LIST_LEN; ii++)
+    {
+        mock_mac (mac, ii);
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mac, 1));
+    }
+
+    mock_mac (mac, APP_MAC_LIST_LEN);
+    TEST_ASSERT_EQUAL (RD_ERROR_NO_MEM, app_mac_list_add (mac, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    TEST_ASSERT_EQUAL (APP_MAC_LIST_LEN, app_mac_list_count());
+
+    for (uint16_t ii = 0; ii < APP_MAC_LIST_LEN; ii++)
+    {
+        mock_mac (mac, ii);
+        TEST_ASSERT_TRUE (app_mac_list_is_passed (mac));
+    }
+}
+
+void test_app_mac_list_add_without_clear (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+    mock_mac (mac, 1);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_DENY));
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_STATE, app_mac_list_add (mac, 1));
+}
+
+void test_app_mac_list_upload_keeps_previous_list_active (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+    uint8_t other[APP_MAC_LIST_MAC_LEN];
+    mock_mac (mac, 1);
+    mock_mac (other, 2);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mac, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    app_mac_list_clear();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (other, 1));
+    // Previous list is applied until new one is activated.
+    TEST_ASSERT_TRUE (app_mac_list_is_passed (mac));
+    TEST_ASSERT_FALSE (app_mac_list_is_passed (other));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    TEST_ASSERT_FALSE (app_mac_list_is_passed (mac));
+    TEST_ASSERT_TRUE (app_mac_list_is_passed (other));
+}
+
+void test_app_mac_list_mode_set_keeps_active_list (void)
+{
+    uint8_t mac[APP_MAC_LIST_MAC_LEN];
+    mock_mac (mac, 1);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_add (mac, 1));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_ALLOW));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_mac_list_mode_set (APP_MAC_LIST_MODE_DENY));
+    TEST_ASSERT_EQUAL (1, app_mac_list_count());
+    TEST_ASSERT_FALSE (app_mac_list_is_passed (mac));
+}
+
+void test_app_mac_list_add_null (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_mac_list_add (NULL, 1));
+}
+
+void test_app_mac_list_mode_invalid (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_mac_list_mode_set (APP_MAC_LIST_MODE_NUM));
+}
@@ -0,0 +1,143 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_scan_schedule.h"
+#include <string.h>
+
+static const uint8_t m_schedule[] =
+{
+    APP_SCAN_SCHEDULE_PHY_1M, APP_SCAN_SCHEDULE_CH_37 | APP_SCAN_SCHEDULE_CH_39, 0xF4, 0x01,
+    APP_SCAN_SCHEDULE_PHY_CODED, APP_SCAN_SCHEDULE_CH_38, 0xE8, 0x03,
+};
+
+void setUp (void)
+{
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (NULL, 0));
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_scan_schedule_empty (void)
+{
+    app_scan_schedule_entry_t entry;
+    TEST_ASSERT_EQUAL (0, app_scan_schedule_len_get());
+    TEST_ASSERT_FALSE (app_scan_schedule_entry_get (&entry));
+}
+
+void test_app_scan_schedule_set_decodes (void)
+{
+    app_scan_schedule_entry_t entry;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (m_schedule, sizeof (m_schedule)));
+    TEST_ASSERT_EQUAL (2, app_scan_schedule_len_get());
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    TEST_ASSERT_EQUAL (APP_SCAN_SCHEDULE_PHY_1M, entry.phy);
+    TEST_ASSERT_TRUE (entry.channels.channel_37);
+    TEST_ASSERT_FALSE (entry.channels.channel_38);
+    TEST_ASSERT_TRUE (entry.channels.channel_39);
+    TEST_ASSERT_EQUAL (500, entry.window_ms);
+    app_scan_schedule_advance (500);
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    TEST_ASSERT_EQUAL (APP_SCAN_SCHEDULE_PHY_CODED, entry.phy);
+    TEST_ASSERT_FALSE (entry.channels.channel_37);
+    TEST_ASSERT_TRUE (entry.channels.channel_38);
+    TEST_ASSERT_FALSE (entry.channels.channel_39);
+    TEST_ASSERT_EQUAL (1000, entry.window_ms);
+}
+
+void test_app_scan_schedule_wraps (void)
+{
+    app_scan_schedule_entry_t entry;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (m_schedule, sizeof (m_schedule)));
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    app_scan_schedule_advance (500);
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    app_scan_schedule_advance (1000);
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    TEST_ASSERT_EQUAL (500, entry.window_ms);
+}
+
+void test_app_scan_schedule_time (void)
+{
+    app_scan_schedule_entry_t entry;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (m_schedule, sizeof (m_schedule)));
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    app_scan_schedule_advance (501);
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    app_scan_schedule_advance (999);
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    app_scan_schedule_advance (502);
+    TEST_ASSERT_EQUAL (1003, app_scan_schedule_time_take (0));
+    TEST_ASSERT_EQUAL (999, app_scan_schedule_time_take (1));
+    TEST_ASSERT_EQUAL (0, app_scan_schedule_time_take (0));
+    TEST_ASSERT_EQUAL (0, app_scan_schedule_time_take (APP_SCAN_SCHEDULE_LEN));
+}
+
+void test_app_scan_schedule_set_restarts (void)
+{
+    app_scan_schedule_entry_t entry;
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (m_schedule, sizeof (m_schedule)));
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    app_scan_schedule_advance (500);
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (m_schedule, sizeof (m_schedule)));
+    TEST_ASSERT_EQUAL (0, app_scan_schedule_time_take (0));
+    // Entry taken from previous schedule is not accounted to new one.
+    app_scan_schedule_advance (1000);
+    TEST_ASSERT_EQUAL (0, app_scan_schedule_time_take (1));
+    TEST_ASSERT_TRUE (app_scan_schedule_entry_get (&entry));
+    TEST_ASSERT_EQUAL (500, entry.window_ms);
+}
+
+void test_app_scan_schedule_set_null (void)
+{
+    TEST_ASSERT_EQUAL (RD_ERROR_NULL, app_scan_schedule_set (NULL, sizeof (m_schedule)));
+}
+
+void test_app_scan_schedule_set_too_long (void)
+{
+    uint8_t schedule[ (APP_SCAN_SCHEDULE_LEN + 1U) * APP_SCAN_SCHEDULE_ENTRY_LEN];
+
+    for (size_t ii = 0; ii < sizeof (schedule); ii += APP_SCAN_SCHEDULE_ENTRY_LEN)
+    {
+        memcpy (&schedule[ii], m_schedule, APP_SCAN_SCHEDULE_ENTRY_LEN);
+    }
+
+    TEST_ASSERT_EQUAL (RD_ERROR_DATA_SIZE,
+                       app_scan_schedule_set (schedule, sizeof (schedule)));
+    TEST_ASSERT_EQUAL (RD_SUCCESS,
+                       app_scan_schedule_set (schedule, sizeof (schedule)
+                                              - APP_SCAN_SCHEDULE_ENTRY_LEN));
+    TEST_ASSERT_EQUAL (APP_SCAN_SCHEDULE_LEN, app_scan_schedule_len_get());
+}
+
+void test_app_scan_schedule_set_invalid_keeps_previous (void)
+{
+    uint8_t schedule[sizeof (m_schedule)];
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_scan_schedule_set (m_schedule, sizeof (m_schedule)));
+    // Partial entry.
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM,
+                       app_scan_schedule_set (m_schedule, sizeof (m_schedule) - 1U));
+    // Unknown PHY.
+    memcpy (schedule, m_schedule, sizeof (schedule));
+    schedule[4] = APP_SCAN_SCHEDULE_PHY_NUM;
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_scan_schedule_set (schedule,
+                       sizeof (schedule)));
+    // No channels.
+    memcpy (schedule, m_schedule, sizeof (schedule));
+    schedule[1] = 0;
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_scan_schedule_set (schedule,
+                       sizeof (schedule)));
+    // Unknown channel.
+    schedule[1] = 0x08U;
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_scan_schedule_set (schedule,
+                       sizeof (schedule)));
+    // Too short window.
+    memcpy (schedule, m_schedule, sizeof (schedule));
+    schedule[2] = (uint8_t) (APP_SCAN_SCHEDULE_WINDOW_MIN_MS - 1U);
+    schedule[3] = 0;
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_PARAM, app_scan_schedule_set (schedule,
+                       sizeof (schedule)));
+    TEST_ASSERT_EQUAL (2, app_scan_schedule_len_get());
+}
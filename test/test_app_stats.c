@@ -0,0 +1,90 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_stats.h"
+#include "ble_gap.h"
+
+void setUp (void)
+{
+    app_stats_reset();
+}
+
+void tearDown (void)
+{
+}
+
+static void scan_count (const uint8_t primary_phy, const uint8_t secondary_phy,
+                        const uint8_t ch_index)
+{
+    ri_adv_scan_t scan = {0};
+    scan.primary_phy = primary_phy;
+    scan.secondary_phy = secondary_phy;
+    scan.ch_index = ch_index;
+    app_stats_rx_count (&scan);
+}
+
+void test_app_stats_inc_get_reset (void)
+{
+    app_stats_inc (APP_STATS_TX_SEND_FAIL);
+    app_stats_inc (APP_STATS_TX_SEND_FAIL);
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_TX_SEND_FAIL));
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_TX_QUEUE_FULL));
+    app_stats_reset();
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_TX_SEND_FAIL));
+}
+
+void test_app_stats_out_of_range (void)
+{
+    app_stats_inc (APP_STATS_NUM);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_NUM));
+}
+
+void test_app_stats_rx_legacy_by_primary_phy (void)
+{
+    scan_count (BLE_GAP_PHY_1MBPS, BLE_GAP_PHY_NOT_SET, 37);
+    scan_count (BLE_GAP_PHY_1MBPS, BLE_GAP_PHY_NOT_SET, 38);
+    scan_count (BLE_GAP_PHY_1MBPS, BLE_GAP_PHY_NOT_SET, 39);
+    TEST_ASSERT_EQUAL (3, app_stats_get (APP_STATS_RX_1MBPS));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CH_37));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CH_38));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CH_39));
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_RX_CH_SECONDARY));
+}
+
+void test_app_stats_rx_extended_by_secondary_phy (void)
+{
+    scan_count (BLE_GAP_PHY_1MBPS, BLE_GAP_PHY_2MBPS, 5);
+    scan_count (BLE_GAP_PHY_CODED, BLE_GAP_PHY_CODED, 20);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_RX_1MBPS));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_2MBPS));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_CODED));
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_RX_CH_SECONDARY));
+}
+
+void test_app_stats_rx_null (void)
+{
+    app_stats_rx_count (NULL);
+
+    for (uint8_t ii = 0; ii < APP_STATS_NUM; ii++)
+    {
+        TEST_ASSERT_EQUAL (0, app_stats_get ((app_stats_counter_t) ii));
+    }
+}
+
+void test_app_stats_ch_count (void)
+{
+    ri_adv_scan_t scan = {0};
+    scan.ch_index = 38;
+    app_stats_ch_count (APP_STATS_ACCEPT_CH_37, &scan);
+    scan.ch_index = 39;
+    app_stats_ch_count (APP_STATS_INVALID_CH_37, &scan);
+    // Secondary channels are not counted.
+    scan.ch_index = 5;
+    app_stats_ch_count (APP_STATS_ACCEPT_CH_37, &scan);
+    app_stats_ch_count (APP_STATS_ACCEPT_CH_37, NULL);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_ACCEPT_CH_37));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_ACCEPT_CH_38));
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_ACCEPT_CH_39));
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_INVALID_CH_39));
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_INVALID_CH_38));
+}
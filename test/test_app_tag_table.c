@@ -0,0 +1,97 @@
+#include "unity.h"
+
+#include "app_config.h"
+#include "app_tag_table.h"
+#include <string.h>
+
+static void mock_mac (uint8_t * const p_mac, const uint8_t id)
+{
+    const uint8_t mac[APP_TAG_MAC_LEN] = {0xFA, 0xEB, 0xDC, 0xCD, 0xBE, id};
+    memcpy (p_mac, mac, sizeof (mac));
+}
+
+void setUp (void)
+{
+    app_tag_table_clear();
+}
+
+void tearDown (void)
+{
+}
+
+void test_app_tag_table_get_new_and_existing (void)
+{
+    uint8_t mac[APP_TAG_MAC_LEN];
+    bool is_new = false;
+    mock_mac (mac, 1);
+    app_tag_t * const p_tag = app_tag_table_get (mac, 100, &is_new);
+    TEST_ASSERT_TRUE (is_new);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY (mac, p_tag->mac, APP_TAG_MAC_LEN);
+    TEST_ASSERT_EQUAL (0, p_tag->fingerprint);
+    p_tag->fingerprint = 0x1234;
+    TEST_ASSERT_EQUAL_PTR (p_tag, app_tag_table_get (mac, 200, &is_new));
+    TEST_ASSERT_FALSE (is_new);
+    TEST_ASSERT_EQUAL (0x1234, p_tag->fingerprint);
+    TEST_ASSERT_EQUAL (200, p_tag->last_seen_ms);
+    TEST_ASSERT_EQUAL (1, app_tag_table_count());
+}
+
+void test_app_tag_table_evicts_least_recently_seen (void)
+{
+    uint8_t mac[APP_TAG_MAC_LEN];
+    bool is_new = false;
+
+    for (uint8_t ii = 0; ii < APP_TAG_TABLE_LEN; ii++)
+    {
+        mock_mac (mac, ii);
+        (void) app_tag_table_get (mac, 1000U + ii, &is_new);
+    }
+
+    // Refresh first tag so that second one becomes the oldest.
+    mock_mac (mac, 0);
+    (void) app_tag_table_get (mac, 2000U, &is_new);
+    mock_mac (mac, APP_TAG_TABLE_LEN);
+    (void) app_tag_table_get (mac, 2001U, &is_new);
+    TEST_ASSERT_TRUE (is_new);
+    TEST_ASSERT_EQUAL (APP_TAG_TABLE_LEN, app_tag_table_count());
+    mock_mac (mac, 0);
+    (void) app_tag_table_get (mac, 2002U, &is_new);
+    TEST_ASSERT_FALSE (is_new);
+    mock_mac (mac, 1);
+    (void) app_tag_table_get (mac, 2003U, &is_new);
+    TEST_ASSERT_TRUE (is_new);
+}
+
+void test_app_tag_table_lru_across_clock_wrap (void)
+{
+    uint8_t mac[APP_TAG_MAC_LEN];
+    bool is_new = false;
+
+    for (uint8_t ii = 0; ii < APP_TAG_TABLE_LEN; ii++)
+    {
+        mock_mac (mac, ii);
+        // First tag is seen just before wraparound, rest after it.
+        (void) app_tag_table_get (mac, (0U == ii) ? (UINT32_MAX - 10U) : ii, &is_new);
+    }
+
+    mock_mac (mac, APP_TAG_TABLE_LEN);
+    (void) app_tag_table_get (mac, 100U, &is_new);
+    mock_mac (mac, 1);
+    (void) app_tag_table_get (mac, 101U, &is_new);
+    TEST_ASSERT_FALSE (is_new);
+    mock_mac (mac, 0);
+    (void) app_tag_table_get (mac, 102U, &is_new);
+    TEST_ASSERT_TRUE (is_new);
+}
+
+void test_app_tag_table_clear (void)
+{
+    uint8_t mac[APP_TAG_MAC_LEN];
+    bool is_new = false;
+    mock_mac (mac, 1);
+    (void) app_tag_table_get (mac, 100, &is_new);
+    app_tag_table_clear();
+    TEST_ASSERT_EQUAL (0, app_tag_table_count());
+    (void) app_tag_table_get (mac, 100, &is_new);
+    TEST_ASSERT_TRUE (is_new);
+}
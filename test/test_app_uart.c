@@ -1,8 +1,17 @@
 #include "unity.h"
 
+#include "app_config.h"
 #include "ble_gap.h"
+#include "app_ca_uart_ext.h"
+#include "app_clock.h"
+#include "app_latency.h"
+#include "app_stats.h"
 #include "app_uart.h"
+#include "mock_app_adv_filter.h"
+#include "mock_app_adv_match.h"
 #include "mock_app_ble.h"
+#include "mock_app_mac_list.h"
+#include "mock_app_scan_schedule.h"
 #include "ruuvi_boards.h"
 #include "mock_ruuvi_interface_communication_ble_advertising.h"
 #include "mock_ruuvi_interface_communication.h"
@@ -11,6 +20,7 @@
 #include "mock_ruuvi_endpoint_ca_uart.h"
 #include "mock_ruuvi_interface_communication_uart.h"
 #include "mock_ruuvi_interface_scheduler.h"
+#include "mock_ruuvi_interface_timer.h"
 #include "mock_ruuvi_interface_yield.h"
 #include "mock_ruuvi_interface_watchdog.h"
 #include "mock_ruuvi_library_ringbuffer.h"
@@ -38,7 +48,6 @@ const uint8_t mock_mac[BLE_MAC_ADDRESS_LENGTH] = MOCK_MAC_ADDR_INIT();
         0x8DU \
     }
 const uint8_t mock_data[] = MOCK_DATA_INIT();
-const uint16_t mock_manuf_id = 0x0499;
 
 static uint8_t t_ring_buffer[128] = {0};
 static bool t_buffer_wlock = false;
@@ -60,10 +69,12 @@ static rl_ringbuffer_t t_uart_ring_buffer =
 };
 
 static size_t mock_sends = 0;
+static ri_comm_message_t mock_last_msg;
 // Mock sending fp for data through uart.
 static rd_status_t mock_send (ri_comm_message_t * const msg)
 {
     mock_sends++;
+    memcpy (&mock_last_msg, msg, sizeof (mock_last_msg));
     return RD_SUCCESS;
 }
 
@@ -151,6 +162,10 @@ void setUp (void)
 {
     mock_sends = 0;
     app_uart_init_globs();
+    app_clock_test_cycles_set (0);
+    app_clock_test_ticks_set (0);
+    app_latency_init();
+    app_stats_reset();
 }
 
 void tearDown (void)
@@ -246,11 +261,8 @@ void test_app_uart_send_broadcast_ok_regular (void)
         .tx_power = BLE_GAP_POWER_LEVEL_INVALID,
     };
     test_app_uart_init_ok();
-    ri_adv_parse_manuid_ExpectAnyArgsAndReturn (mock_manuf_id);
-    uint16_t manufacturer_id = 0x0499;
-    app_ble_manufacturer_filter_enabled_ExpectAndReturn (&manufacturer_id, true);
     re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
-    err_code |= app_uart_send_broadcast (&scan); // Call the function under test
+    err_code |= app_uart_send_broadcast (&scan, 0); // Call the function under test
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
     TEST_ASSERT_EQUAL (1, mock_sends);
 }
@@ -274,11 +286,8 @@ void test_app_uart_on_evt_send_device_id_when_tx_in_progress_does_not_schedule (
         .ch_index = 37,
         .tx_power = BLE_GAP_POWER_LEVEL_INVALID,
     };
-    ri_adv_parse_manuid_ExpectAnyArgsAndReturn (mock_manuf_id);
-    uint16_t manufacturer_id = 0x0499;
-    app_ble_manufacturer_filter_enabled_ExpectAndReturn (&manufacturer_id, true);
     re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
-    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&scan));
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&scan, 0));
     TEST_ASSERT_EQUAL (1, mock_sends);
     // Now TX is in progress. Calling app_uart_on_evt_send_device_id should NOT
     // schedule app_uart_on_evt_tx_finish. We deliberately set no expectation for
@@ -334,11 +343,8 @@ void test_app_uart_send_broadcast_ok_coded_phy (void)
         .tx_power = 8,
     };
     test_app_uart_init_ok();
-    ri_adv_parse_manuid_ExpectAnyArgsAndReturn (mock_manuf_id);
-    uint16_t manufacturer_id = 0x0499;
-    app_ble_manufacturer_filter_enabled_ExpectAndReturn (&manufacturer_id, true);
     re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
-    err_code |= app_uart_send_broadcast (&scan); // Call the function under test
+    err_code |= app_uart_send_broadcast (&scan, 0); // Call the function under test
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
     TEST_ASSERT_EQUAL (1, mock_sends);
 }
@@ -359,11 +365,8 @@ void test_app_uart_send_broadcast_ok_extended_adv_2m_phy (void)
         .tx_power = 0,
     };
     test_app_uart_init_ok();
-    ri_adv_parse_manuid_ExpectAnyArgsAndReturn (mock_manuf_id);
-    uint16_t manufacturer_id = 0x0499;
-    app_ble_manufacturer_filter_enabled_ExpectAndReturn (&manufacturer_id, true);
     re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
-    err_code |= app_uart_send_broadcast (&scan); // Call the function under test
+    err_code |= app_uart_send_broadcast (&scan, 0); // Call the function under test
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
     TEST_ASSERT_EQUAL (1, mock_sends);
 }
@@ -404,11 +407,8 @@ void test_app_uart_send_broadcast_ok_phy_auto (void)
         .tx_power = -1,
     };
     test_app_uart_init_ok();
-    ri_adv_parse_manuid_ExpectAnyArgsAndReturn (mock_manuf_id);
-    uint16_t manufacturer_id = 0x0499;
-    app_ble_manufacturer_filter_enabled_ExpectAndReturn (&manufacturer_id, true);
     re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
-    err_code |= app_uart_send_broadcast (&scan); // Call the function under test
+    err_code |= app_uart_send_broadcast (&scan, 0); // Call the function under test
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
     TEST_ASSERT_EQUAL (1, mock_sends);
 }
@@ -417,7 +417,7 @@ void test_app_uart_send_broadcast_null (void)
 {
     rd_status_t err_code = RD_SUCCESS;
     test_app_uart_init_ok();
-    err_code |= app_uart_send_broadcast (NULL);
+    err_code |= app_uart_send_broadcast (NULL, 0);
     TEST_ASSERT_EQUAL (RD_ERROR_NULL, err_code);
     TEST_ASSERT_EQUAL (0, mock_sends);
 }
@@ -431,13 +431,11 @@ void test_app_uart_send_broadcast_encoding_error (void)
     memcpy (scan.data, &mock_data, sizeof (mock_data));
     scan.data_len = sizeof (mock_data);
     test_app_uart_init_ok();
-    ri_adv_parse_manuid_ExpectAnyArgsAndReturn (mock_manuf_id);
-    uint16_t manufacturer_id = 0x0499;
-    app_ble_manufacturer_filter_enabled_ExpectAndReturn (&manufacturer_id, true);
     re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_ERROR_INTERNAL);
-    err_code |= app_uart_send_broadcast (&scan);
+    err_code |= app_uart_send_broadcast (&scan, 0);
     TEST_ASSERT_EQUAL (RD_ERROR_INVALID_DATA, err_code);
     TEST_ASSERT_EQUAL (0, mock_sends);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_ENCODE_FAIL));
 }
 
 void test_app_uart_send_broadcast_error_size (void)
@@ -449,11 +447,728 @@ void test_app_uart_send_broadcast_error_size (void)
     memcpy (scan.data, &mock_data, sizeof (mock_data));
     scan.data_len = 255U;
     test_app_uart_init_ok();
-    err_code |= app_uart_send_broadcast (&scan);
+    err_code |= app_uart_send_broadcast (&scan, 0);
     TEST_ASSERT_EQUAL (RD_ERROR_DATA_SIZE, err_code);
     TEST_ASSERT_EQUAL (0, mock_sends);
 }
 
+static const ri_adv_scan_t mock_queue_scan =
+{
+    .addr = MOCK_MAC_ADDR_INIT(),
+    .rssi = -50,
+    .data = MOCK_DATA_INIT(),
+    .data_len = sizeof (mock_data),
+    .is_coded_phy = false,
+    .primary_phy = RE_CA_UART_BLE_PHY_1MBPS,
+    .secondary_phy = RE_CA_UART_BLE_PHY_NOT_SET,
+    .ch_index = 37,
+    .tx_power = BLE_GAP_POWER_LEVEL_INVALID,
+};
+
+static void send_broadcast_expect (void)
+{
+    re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
+}
+
+void test_app_uart_send_broadcast_queued_while_tx_in_progress (void)
+{
+    test_app_uart_init_ok();
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    // Second frame waits in queue until first one is on the wire.
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (2, mock_sends);
+    // Queue is empty, nothing more to send.
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (2, mock_sends);
+    TEST_ASSERT_EQUAL (0, app_uart_tx_drops_get());
+}
+
+void test_app_uart_send_broadcast_queue_full_drops (void)
+{
+    test_app_uart_init_ok();
+
+    // One frame goes on the wire, rest fill the queue.
+    for (size_t ii = 0; ii < (APP_UART_TX_QUEUE_LEN + 1U); ii++)
+    {
+        send_broadcast_expect();
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    }
+
+    TEST_ASSERT_TRUE (app_uart_tx_queue_is_full());
+    // Full queue is detected before encoding, re_ca_uart_encode is not called.
+    TEST_ASSERT_EQUAL (RD_ERROR_NO_MEM, app_uart_send_broadcast (&mock_queue_scan, 0));
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (1, app_uart_tx_drops_get());
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_FALSE (app_uart_tx_queue_is_full());
+}
+
+void test_app_uart_send_broadcast_encoding_error_frees_slot (void)
+{
+    test_app_uart_init_ok();
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_ERROR_INTERNAL);
+    TEST_ASSERT_EQUAL (RD_ERROR_INVALID_DATA, app_uart_send_broadcast (&mock_queue_scan, 0));
+    // Failed encode must not leave a half-written frame in queue.
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+}
+
+void test_app_uart_tx_queue_send_error_counts_drop (void)
+{
+    static ri_uart_init_t config =
+    {
+        .hwfc_enabled = RB_HWFC_ENABLED,
+        .parity_enabled = RB_PARITY_ENABLED,
+        .cts  = RB_UART_CTS_PIN,
+        .rts  = RB_UART_RTS_PIN,
+        .tx   = RB_UART_TX_PIN,
+        .rx   = RB_UART_RX_PIN,
+        .baud = RI_UART_BAUD_115200
+    };
+    ri_uart_init_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    ri_uart_init_ReturnThruPtr_channel (&dummy_uart_error);
+    ri_uart_config_ExpectWithArrayAndReturn (&config, 1, RD_SUCCESS);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_init());
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_ERROR_INTERNAL, app_uart_send_broadcast (&mock_queue_scan, 0));
+    TEST_ASSERT_EQUAL (1, app_uart_tx_drops_get());
+}
+
+static void parser_set_report_mode_expect (const uint8_t mode, const uint8_t max_batch)
+{
+    const uint8_t payload[] = {mode, max_batch};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_encode (frame, &frame_len,
+                       APP_CA_UART_EXT_SET_REPORT_MODE, payload, sizeof (payload)));
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_report_mode_acks (void)
+{
+    app_ca_uart_ext_frame_t ack = {0};
+    test_app_uart_init_ok();
+    parser_set_report_mode_expect (APP_CA_UART_EXT_REPORT_BATCH, 0);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_ack (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &ack));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_ACK, ack.cmd);
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_SET_REPORT_MODE, ack.p_payload[0]);
+    TEST_ASSERT_EQUAL (RE_CA_ACK_OK, ack.p_payload[1]);
+}
+
+void test_app_uart_parser_set_report_mode_invalid_nacks (void)
+{
+    app_ca_uart_ext_frame_t ack = {0};
+    test_app_uart_init_ok();
+    parser_set_report_mode_expect (APP_CA_UART_EXT_REPORT_BATCH + 1U, 0);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_ack (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &ack));
+    TEST_ASSERT_EQUAL (RE_CA_ACK_ERROR, ack.p_payload[1]);
+}
+
+void test_app_uart_parser_set_dedup_window (void)
+{
+    const uint8_t payload[] = {0xF4, 0x01};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_DEDUP_WINDOW, payload,
+                            sizeof (payload));
+    app_adv_filter_dedup_window_set_Expect (500U);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_ext_split_frame (void)
+{
+    const uint8_t payload[] = {0xF4, 0x01};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    uint8_t * p_bytes[sizeof (frame)];
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_DEDUP_WINDOW, payload,
+                            sizeof (payload));
+    // First 3 bytes were queued into ring buffer by previous UART event.
+    re_ca_uart_decode_ExpectAnyArgsAndReturn (RE_ERROR_DECODING_CRC);
+
+    for (size_t ii = 3; ii < frame_len; ii++)
+    {
+        rl_ringbuffer_queue_ExpectAnyArgsAndReturn (RL_SUCCESS);
+    }
+
+    for (size_t ii = 0; ii < frame_len; ii++)
+    {
+        p_bytes[ii] = &frame[ii];
+        rl_ringbuffer_dequeue_ExpectAnyArgsAndReturn (RL_SUCCESS);
+        rl_ringbuffer_dequeue_ReturnMemThruPtr_data (&p_bytes[ii], sizeof (uint8_t *));
+    }
+
+    rl_ringbuffer_dequeue_ExpectAnyArgsAndReturn (RL_ERROR_NO_DATA);
+    app_adv_filter_dedup_window_set_Expect (500U);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (&frame[3], (uint16_t) (frame_len - 3U));
+}
+
+void test_app_uart_parser_set_rate_limit (void)
+{
+    const uint8_t payload[] = {0x10, 0x27};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_RATE_LIMIT, payload,
+                            sizeof (payload));
+    app_adv_filter_rate_limit_set_ExpectAndReturn (10000U, RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_rssi_floor (void)
+{
+    const uint8_t payload[] = {(uint8_t) -85, 5};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_RSSI_FLOOR, payload,
+                            sizeof (payload));
+    app_adv_filter_rssi_floor_set_Expect (-85, 5);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_mac_list_add (void)
+{
+    const uint8_t payload[] =
+    {
+        0xFA, 0xEB, 0xDC, 0xCD, 0xBE, 0x01,
+        0xFA, 0xEB, 0xDC, 0xCD, 0xBE, 0x02
+    };
+    uint8_t frame[32] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_MAC_LIST_ADD, payload,
+                            sizeof (payload));
+    app_mac_list_add_ExpectWithArrayAndReturn (payload, sizeof (payload), 2, RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_mac_list_add_partial_mac_nacks (void)
+{
+    app_ca_uart_ext_frame_t ack = {0};
+    const uint8_t payload[] = {0xFA, 0xEB, 0xDC, 0xCD, 0xBE};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_MAC_LIST_ADD, payload,
+                            sizeof (payload));
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_ack (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &ack));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_MAC_LIST_ADD, ack.p_payload[0]);
+    TEST_ASSERT_EQUAL (RE_CA_ACK_ERROR, ack.p_payload[1]);
+}
+
+void test_app_uart_parser_mac_list_add_too_many_nacks (void)
+{
+    app_ca_uart_ext_frame_t ack = {0};
+    uint8_t payload[ (APP_CA_UART_EXT_MAC_LIST_ADD_MAX + 1U) * APP_MAC_LIST_MAC_LEN] = {0};
+    uint8_t frame[sizeof (payload) + APP_CA_UART_EXT_OVERHEAD] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_MAC_LIST_ADD, payload,
+                            sizeof (payload));
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_ack (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &ack));
+    TEST_ASSERT_EQUAL (RE_CA_ACK_ERROR, ack.p_payload[1]);
+}
+
+void test_app_uart_parser_mac_list_clear_and_mode (void)
+{
+    const uint8_t payload[] = {APP_MAC_LIST_MODE_DENY};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_MAC_LIST_CLEAR, NULL, 0);
+    app_mac_list_clear_Expect();
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_MAC_LIST_MODE, payload,
+                            sizeof (payload));
+    app_mac_list_mode_set_ExpectAndReturn (APP_MAC_LIST_MODE_DENY, RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_scan_mode (void)
+{
+    const uint8_t payload[] = {APP_BLE_SCAN_MODE_CONCURRENT};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_SCAN_MODE, payload,
+                            sizeof (payload));
+    app_ble_scan_mode_set_ExpectAndReturn (APP_BLE_SCAN_MODE_CONCURRENT, RD_SUCCESS);
+    app_ble_scan_start_ExpectAndReturn (RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_scan_mode_not_supported (void)
+{
+    const uint8_t payload[] = {APP_BLE_SCAN_MODE_CONCURRENT};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_SCAN_MODE, payload,
+                            sizeof (payload));
+    app_ble_scan_mode_set_ExpectAndReturn (APP_BLE_SCAN_MODE_CONCURRENT,
+                                           RD_ERROR_NOT_SUPPORTED);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_phy_share (void)
+{
+    const uint8_t payload[] = {20U, 60U};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_PHY_SHARE, payload,
+                            sizeof (payload));
+    app_ble_phy_share_set_ExpectAndReturn (20U, 60U, RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_scan_timing (void)
+{
+    const uint8_t payload[] = {0xF4, 0x01, 0x64, 0x00, 0xE8, 0x03};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_SCAN_TIMING, payload,
+                            sizeof (payload));
+    app_ble_scan_timing_set_ExpectAndReturn (500U, 100U, 1000U, RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_channel_dwell (void)
+{
+    const uint8_t payload[] = {1U, 5U, 70U};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_CHANNEL_DWELL, payload,
+                            sizeof (payload));
+    app_ble_channel_dwell_set_ExpectAndReturn (true, 5U, 70U, RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_scan_schedule (void)
+{
+    const uint8_t payload[] =
+    {
+        APP_SCAN_SCHEDULE_PHY_CODED, APP_SCAN_SCHEDULE_CH_37, 0xF4, 0x01
+    };
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_SCAN_SCHEDULE, payload,
+                            sizeof (payload));
+    app_scan_schedule_set_ExpectWithArrayAndReturn (payload, sizeof (payload),
+            sizeof (payload), RD_SUCCESS);
+    app_ble_scan_start_ExpectAndReturn (RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_scan_schedule_invalid (void)
+{
+    const uint8_t payload[] =
+    {
+        APP_SCAN_SCHEDULE_PHY_NUM, APP_SCAN_SCHEDULE_CH_37, 0xF4, 0x01
+    };
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_SCAN_SCHEDULE, payload,
+                            sizeof (payload));
+    app_scan_schedule_set_ExpectAnyArgsAndReturn (RD_ERROR_INVALID_PARAM);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_manufacturer_ids (void)
+{
+    const uint8_t payload[] =
+    {
+        APP_CA_UART_EXT_MANUFACTURER_ACCEPT_NONE, 0x4C, 0x00, 0x59, 0x00
+    };
+    const uint16_t ids[] = {0x004C, 0x0059};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_MANUFACTURER_IDS,
+                            payload, sizeof (payload));
+    app_adv_filter_manufacturer_extra_set_ExpectWithArrayAndReturn (ids, 2, 2, true,
+            RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_set_match_program (void)
+{
+    const uint8_t payload[] = {APP_ADV_MATCH_OP_LEN, 8, 31, 0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_MATCH_PROGRAM,
+                            payload, sizeof (payload));
+    app_adv_match_program_set_ExpectWithArrayAndReturn (payload, sizeof (payload),
+            sizeof (payload), RD_SUCCESS);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_get_drops (void)
+{
+    app_ca_uart_ext_frame_t drops = {0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_GET_DROPS, NULL, 0);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_reply,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_reply (NULL, 0);
+    app_adv_filter_shed_level_get_ExpectAndReturn (APP_ADV_FILTER_SHED_WEAK);
+
+    for (uint8_t reason = APP_ADV_FILTER_REJECT_INVALID;
+            reason < APP_ADV_FILTER_REASON_NUM; reason++)
+    {
+        app_adv_filter_rejects_get_ExpectAndReturn ((app_adv_filter_reason_t) reason,
+                0x01020300UL + reason);
+    }
+
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &drops));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_DROPS, drops.cmd);
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_DROPS_COUNTERS_POS
+                       + ((APP_ADV_FILTER_REASON_NUM - 1U) * 4U), drops.payload_len);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_SHED_WEAK, drops.p_payload[0]);
+    TEST_ASSERT_EQUAL (APP_ADV_FILTER_REASON_NUM - 1U, drops.p_payload[1]);
+    // Counter of APP_ADV_FILTER_REJECT_INVALID, LSB first.
+    TEST_ASSERT_EQUAL (0x01, drops.p_payload[APP_CA_UART_EXT_DROPS_COUNTERS_POS]);
+    TEST_ASSERT_EQUAL (0x03, drops.p_payload[APP_CA_UART_EXT_DROPS_COUNTERS_POS + 1U]);
+    TEST_ASSERT_EQUAL (0x01, drops.p_payload[APP_CA_UART_EXT_DROPS_COUNTERS_POS + 3U]);
+}
+
+void test_app_uart_parser_get_latency (void)
+{
+    app_ca_uart_ext_frame_t reply = {0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    const uint8_t stage = APP_LATENCY_STAGE_UART;
+    const uint8_t pos = APP_CA_UART_EXT_LATENCY_COUNTS_POS + (2U * 8U);
+    test_app_uart_init_ok();
+    app_latency_record_cycles (APP_LATENCY_STAGE_UART, 300U * APP_CLOCK_CYCLES_PER_US);
+    app_latency_record_cycles (APP_LATENCY_STAGE_UART, 400U * APP_CLOCK_CYCLES_PER_US);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_GET_LATENCY, &stage,
+                            sizeof (stage));
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_reply,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_reply (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &reply));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_LATENCY, reply.cmd);
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_LATENCY_COUNTS_POS
+                       + (2U * APP_LATENCY_BUCKETS), reply.payload_len);
+    TEST_ASSERT_LESS_OR_EQUAL (sizeof (mock_last_msg.data), mock_last_msg.data_length);
+    TEST_ASSERT_EQUAL (APP_LATENCY_STAGE_UART, reply.p_payload[0]);
+    TEST_ASSERT_EQUAL (APP_LATENCY_BUCKETS, reply.p_payload[1]);
+    TEST_ASSERT_EQUAL (2, reply.p_payload[pos]);
+    TEST_ASSERT_EQUAL (0, reply.p_payload[pos + 1U]);
+    // Histograms restart when taken.
+    TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_UART, 8));
+}
+
+void test_app_uart_parser_get_latency_unknown_stage (void)
+{
+    app_ca_uart_ext_frame_t ack = {0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    const uint8_t stage = APP_LATENCY_STAGE_NUM;
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_GET_LATENCY, &stage,
+                            sizeof (stage));
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_ack (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &ack));
+    TEST_ASSERT_EQUAL (RE_CA_ACK_ERROR, ack.p_payload[1]);
+}
+
+void test_app_uart_parser_get_stats (void)
+{
+    app_ca_uart_ext_frame_t reply = {0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_stats_inc (APP_STATS_RX_1MBPS);
+    app_stats_inc (APP_STATS_SCAN_RESTART);
+    app_stats_inc (APP_STATS_SCAN_RESTART);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_GET_STATS, NULL, 0);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_reply,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_reply (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &reply));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_STATS, reply.cmd);
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_STATS_COUNTERS_POS + (4U * APP_STATS_NUM),
+                       reply.payload_len);
+    TEST_ASSERT_EQUAL (APP_STATS_NUM, reply.p_payload[0]);
+    TEST_ASSERT_EQUAL (1, reply.p_payload[APP_CA_UART_EXT_STATS_COUNTERS_POS
+                                          + (4U * APP_STATS_RX_1MBPS)]);
+    TEST_ASSERT_EQUAL (2, reply.p_payload[APP_CA_UART_EXT_STATS_COUNTERS_POS
+                                          + (4U * APP_STATS_SCAN_RESTART)]);
+    // Query does not clear counters.
+    TEST_ASSERT_EQUAL (2, app_stats_get (APP_STATS_SCAN_RESTART));
+}
+
+void test_app_uart_parser_get_scan_schedule_time (void)
+{
+    app_ca_uart_ext_frame_t reply = {0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_GET_SCAN_SCHEDULE_TIME,
+                            NULL, 0);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_reply,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    app_scan_schedule_len_get_ExpectAndReturn (2);
+    app_scan_schedule_time_take_ExpectAndReturn (0, 500U);
+    app_scan_schedule_time_take_ExpectAndReturn (1, 0x10203U);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_reply (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &reply));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_SCAN_SCHEDULE_TIME, reply.cmd);
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS + 8U, reply.payload_len);
+    TEST_ASSERT_EQUAL (2, reply.p_payload[0]);
+    TEST_ASSERT_EQUAL (0xF4, reply.p_payload[APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS]);
+    TEST_ASSERT_EQUAL (0x01, reply.p_payload[APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS + 1U]);
+    TEST_ASSERT_EQUAL (0x03, reply.p_payload[APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS + 4U]);
+    TEST_ASSERT_EQUAL (0x01, reply.p_payload[APP_CA_UART_EXT_SCAN_SCHEDULE_TIME_POS + 6U]);
+}
+
+void test_app_uart_parser_reset_stats (void)
+{
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_stats_inc (APP_STATS_TX_QUEUE_FULL);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_RESET_STATS, NULL, 0);
+    app_adv_filter_rejects_reset_Expect();
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_TX_QUEUE_FULL));
+    TEST_ASSERT_EQUAL (0, app_uart_tx_drops_get());
+}
+
+void test_app_uart_parser_set_max_age (void)
+{
+    const uint8_t payload[] = {0xB8, 0x0B};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_MAX_AGE, payload,
+                            sizeof (payload));
+    app_ble_adv_max_age_set_Expect (3000U);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+}
+
+void test_app_uart_parser_get_queue_age (void)
+{
+    const app_ble_adv_age_t age =
+    {
+        .count = 10,
+        .mean_ms = 300,
+        .max_ms = 0x01020304UL
+    };
+    app_ca_uart_ext_frame_t reply = {0};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_GET_QUEUE_AGE, NULL, 0);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_reply,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_reply (NULL, 0);
+    app_ble_adv_age_take_ExpectAnyArgs();
+    app_ble_adv_age_take_ReturnThruPtr_p_age (&age);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &reply));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_QUEUE_AGE, reply.cmd);
+    TEST_ASSERT_EQUAL (12, reply.payload_len);
+    TEST_ASSERT_EQUAL (10, reply.p_payload[0]);
+    TEST_ASSERT_EQUAL (0x2C, reply.p_payload[4]);
+    TEST_ASSERT_EQUAL (0x01, reply.p_payload[5]);
+    TEST_ASSERT_EQUAL (0x04, reply.p_payload[8]);
+    TEST_ASSERT_EQUAL (0x01, reply.p_payload[11]);
+}
+
+void test_app_uart_parser_set_dedup_window_short_nacks (void)
+{
+    app_ca_uart_ext_frame_t ack = {0};
+    const uint8_t payload[] = {0xF4};
+    uint8_t frame[16] = {0};
+    uint8_t frame_len = sizeof (frame);
+    test_app_uart_init_ok();
+    app_ca_uart_ext_encode (frame, &frame_len, APP_CA_UART_EXT_SET_DEDUP_WINDOW, payload,
+                            sizeof (payload));
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_send_ext_ack,
+                                            RD_SUCCESS);
+    app_uart_parser (frame, frame_len);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    app_uart_on_evt_send_ext_ack (NULL, 0);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &ack));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_SET_DEDUP_WINDOW, ack.p_payload[0]);
+    TEST_ASSERT_EQUAL (RE_CA_ACK_ERROR, ack.p_payload[1]);
+}
+
+void test_app_uart_send_broadcast_batch_mode (void)
+{
+    app_ca_uart_ext_frame_t batch = {0};
+    test_app_uart_init_ok();
+    parser_set_report_mode_expect (APP_CA_UART_EXT_REPORT_BATCH, 0);
+    // UART is idle, first report goes out as a regular frame.
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+
+    // Reports received while UART is busy are packed into one frame.
+    for (size_t ii = 0; ii < 2U; ii++)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    }
+
+    TEST_ASSERT_EQUAL (1, mock_sends);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (2, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &batch));
+    TEST_ASSERT_EQUAL (APP_CA_UART_EXT_ADV_BATCH, batch.cmd);
+    TEST_ASSERT_EQUAL (2, batch.p_payload[0]);
+    TEST_ASSERT_EQUAL (0, app_uart_tx_drops_get());
+}
+
+void test_app_uart_send_broadcast_batch_max_starts_new_frame (void)
+{
+    app_ca_uart_ext_frame_t batch = {0};
+    test_app_uart_init_ok();
+    parser_set_report_mode_expect (APP_CA_UART_EXT_REPORT_BATCH, 2);
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+
+    for (size_t ii = 0; ii < 3U; ii++)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    }
+
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &batch));
+    TEST_ASSERT_EQUAL (2, batch.p_payload[0]);
+    app_uart_on_evt_tx_finish (NULL, 0);
+    TEST_ASSERT_EQUAL (3, mock_sends);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_ca_uart_ext_decode (mock_last_msg.data,
+                       mock_last_msg.data_length, &batch));
+    TEST_ASSERT_EQUAL (1, batch.p_payload[0]);
+}
+
+void test_app_uart_tx_queue_is_full_with_full_batch (void)
+{
+    test_app_uart_init_ok();
+    parser_set_report_mode_expect (APP_CA_UART_EXT_REPORT_BATCH, 2);
+    send_broadcast_expect();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+
+    // Every slot holds a batch, last one is open with room for one more.
+    for (size_t ii = 0; ii < ((2U * APP_UART_TX_QUEUE_LEN) - 1U); ii++)
+    {
+        TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    }
+
+    TEST_ASSERT_FALSE (app_uart_tx_queue_is_full());
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&mock_queue_scan, 0));
+    TEST_ASSERT_TRUE (app_uart_tx_queue_is_full());
+    TEST_ASSERT_EQUAL (0, app_uart_tx_drops_get());
+}
+
 /**
  * @brief Poll scanning configuration through UART.
  *
@@ -582,6 +1297,46 @@ void test_app_uart_isr_sent (void)
     TEST_ASSERT_EQUAL (RD_SUCCESS, err_code);
 }
 
+void test_app_uart_isr_sent_records_latency (void)
+{
+    const ri_adv_scan_t scan =
+    {
+        .addr = MOCK_MAC_ADDR_INIT(),
+        .rssi = -50,
+        .data = MOCK_DATA_INIT(),
+        .data_len = sizeof (mock_data),
+        .primary_phy = RE_CA_UART_BLE_PHY_1MBPS,
+        .ch_index = 37,
+        .tx_power = BLE_GAP_POWER_LEVEL_INVALID,
+    };
+    test_app_uart_init_ok();
+    re_ca_uart_encode_ExpectAnyArgsAndReturn (RD_SUCCESS);
+    // Received 115 RTC ticks before taken from pool, sent 115 ticks after.
+    app_clock_test_ticks_set (1000U);
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_send_broadcast (&scan, 1000U - 115U));
+    // CPU cycle counter stops in sleep, latency must follow the RTC.
+    app_clock_test_cycles_set (0);
+    app_clock_test_ticks_set (1000U + 115U);
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    rd_error_check_ExpectAnyArgs();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_isr (RI_COMM_SENT, NULL, 0));
+    // A second TX complete belongs to no advertisement.
+    ri_scheduler_event_put_ExpectAndReturn (NULL, 0, &app_uart_on_evt_tx_finish,
+                                            RD_SUCCESS);
+    rd_error_check_ExpectAnyArgs();
+    TEST_ASSERT_EQUAL (RD_SUCCESS, app_uart_isr (RI_COMM_SENT, NULL, 0));
+    // 3.5 ms on UART falls in 2048 ... 4095 us, 7.0 ms in total in 4096 ... 8191 us.
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_UART, 11));
+    TEST_ASSERT_EQUAL (1, app_latency_take (APP_LATENCY_STAGE_TOTAL, 12));
+
+    for (uint8_t bucket = 0; bucket < APP_LATENCY_BUCKETS; bucket++)
+    {
+        TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_UART, bucket));
+        TEST_ASSERT_EQUAL (0, app_latency_take (APP_LATENCY_STAGE_TOTAL, bucket));
+    }
+}
+
 void test_app_uart_isr_unknown (void)
 {
     rd_status_t err_code = RD_SUCCESS;
@@ -823,6 +1578,8 @@ void test_app_uart_parser_clean_old (void)
     app_uart_on_evt_send_ack (NULL, 0);
     app_uart_on_evt_tx_finish (NULL, 0);
     TEST_ASSERT_EQUAL (1, mock_sends);
+    // Stale byte was dropped.
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_PARSE_FAIL));
 }
 
 void test_app_uart_parser_part_1_ok (void)
@@ -861,6 +1618,33 @@ void test_app_uart_parser_part_1_ok (void)
     ri_watchdog_feed_IgnoreAndReturn (RD_SUCCESS);
     app_uart_parser ((void *) data_part1, 3);
     TEST_ASSERT_EQUAL (0, mock_sends);
+    // Frame may still be completed by next chunk.
+    TEST_ASSERT_EQUAL (0, app_stats_get (APP_STATS_RX_PARSE_FAIL));
+}
+
+void test_app_uart_parser_overflow_resyncs (void)
+{
+    const uint8_t data[] = {0x01U, 0x02U};
+    uint8_t stale[] = {0x55U, RE_CA_UART_STX, 2 + CMD_IN_LEN};
+    uint8_t * p_stale[sizeof (stale)];
+    re_ca_uart_decode_ExpectAnyArgsAndReturn (RE_ERROR_DECODING_CRC);
+    rl_ringbuffer_queue_ExpectAnyArgsAndReturn (RL_ERROR_NO_MEM);
+
+    for (size_t ii = 0; ii < sizeof (stale); ii++)
+    {
+        p_stale[ii] = &stale[ii];
+        rl_ringbuffer_dequeue_ExpectAnyArgsAndReturn (RL_SUCCESS);
+        rl_ringbuffer_dequeue_ReturnMemThruPtr_data (&p_stale[ii], sizeof (uint8_t *));
+    }
+
+    rl_ringbuffer_dequeue_ExpectAnyArgsAndReturn (RL_ERROR_NO_DATA);
+    re_ca_uart_decode_ExpectAnyArgsAndReturn (RE_ERROR_DECODING_CRC);
+    // Byte before next STX is dropped, rest is queued back.
+    rl_ringbuffer_queue_ExpectAnyArgsAndReturn (RL_SUCCESS);
+    rl_ringbuffer_queue_ExpectAnyArgsAndReturn (RL_SUCCESS);
+    app_uart_parser ((void *) data, sizeof (data));
+    TEST_ASSERT_EQUAL (0, mock_sends);
+    TEST_ASSERT_EQUAL (1, app_stats_get (APP_STATS_RX_PARSE_FAIL));
 }
 
 void test_app_uart_parser_part_2_ok (void)
@@ -5,6 +5,7 @@
 #include "ruuvi_boards.h"
 
 #include "mock_app_ble.h"
+#include "mock_app_clock.h"
 #include "mock_app_uart.h"
 #include "mock_ruuvi_driver_error.h"
 #include "mock_ruuvi_interface_communication_ble_advertising.h"
@@ -53,11 +54,13 @@ void test_app_main (void)
     ri_gpio_init_ExpectAndReturn (RD_SUCCESS);
     leds_expect();
     ri_yield_low_power_enable_ExpectAndReturn (true, RD_SUCCESS);
+    app_clock_init_ExpectAndReturn (RD_SUCCESS);
     app_uart_init_ExpectAndReturn (RD_SUCCESS);
     app_uart_poll_configuration_ExpectAndReturn (RD_SUCCESS);
     app_ble_scan_start_ExpectAndReturn (RD_SUCCESS);
     ri_watchdog_feed_IgnoreAndReturn (RD_SUCCESS);
     ri_scheduler_execute_ExpectAndReturn (RD_SUCCESS);
+    app_ble_adv_forward_ExpectAndReturn (false);
     ri_yield_ExpectAndReturn (RD_SUCCESS);
     app_main();
 }
\ No newline at end of file